@@ -1,11 +1,52 @@
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <latch>
+#include <new>
+#include <numeric>
+#include <random>
 #include <syncstream>
 #include <iostream>
+#include <thread>
+#include <vector>
+
+#if MINIRTS_BENCH_STD_PAR
+#include <execution>
+#endif
 
 #include "api.h"
 #include "bench_utils.h"
 
 
+// Counts every global operator new, so benchmarks can report heap allocations per task.
+static std::atomic<uint64_t> heap_allocations {0};
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+
 
 // Measures the throughput when enqueuing 1 million empty tasks with enqueue()
 // (e.g. the length per task.)
@@ -23,6 +64,7 @@ static void BM_Enqueue_Throughput_1_000_000(benchmark::State &state) {
 
         state.ResumeTiming();
 
+        const uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
         auto start = std::chrono::steady_clock::now();
 
         for (int i = 0; i < LOOP; ++i) {
@@ -33,12 +75,14 @@ static void BM_Enqueue_Throughput_1_000_000(benchmark::State &state) {
 
         auto end = std::chrono::steady_clock::now();
         std::chrono::duration<double, std::nano> elapsed = end - start;
+        const uint64_t allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
 
 
         state.counters["Threads"]       = num_threads;
         state.counters["QueueCapacity"] = queue_capacity;
         state.counters["ns_per_task"]   = elapsed.count() / LOOP;
         state.counters["Throughput_Mops"] = (LOOP / elapsed.count()) * 1e3;
+        state.counters["allocs_per_task"] = static_cast<double>(allocs) / LOOP;
     }
 }
 
@@ -124,6 +168,7 @@ static void BM_Async_Throughput_1_000_000(benchmark::State &state) {
 
         state.ResumeTiming();
 
+        const uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
         auto start = std::chrono::steady_clock::now();
 
         for (int i = 0; i < LOOP; ++i) {
@@ -134,12 +179,14 @@ static void BM_Async_Throughput_1_000_000(benchmark::State &state) {
 
         auto end = std::chrono::steady_clock::now();
         std::chrono::duration<double, std::nano> elapsed = end - start;
+        const uint64_t allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
 
 
         state.counters["Threads"]       = num_threads;
         state.counters["QueueCapacity"] = queue_capacity;
         state.counters["ns_per_task"]   = elapsed.count() / LOOP;
         state.counters["Throughput_Mops"] = (LOOP / elapsed.count()) * 1e3;
+        state.counters["allocs_per_task"] = static_cast<double>(allocs) / LOOP;
     }
 }
 
@@ -318,6 +365,7 @@ static void BM_Then_Chain_1_000_000(benchmark::State &state) {
 
         state.ResumeTiming();
 
+        const uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
         auto start = std::chrono::steady_clock::now();
 
         auto fut = rts::async::spawn([] {});
@@ -328,6 +376,7 @@ static void BM_Then_Chain_1_000_000(benchmark::State &state) {
 
         auto end = std::chrono::steady_clock::now();
         std::chrono::duration<double, std::nano> elapsed = end - start;
+        const uint64_t allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
 
         state.PauseTiming();
         rts::finalize_soft();
@@ -340,6 +389,7 @@ static void BM_Then_Chain_1_000_000(benchmark::State &state) {
         state.counters["ns_per_then"]     = elapsed.count() / LOOP;
         state.counters["Total_ns"]        = elapsed.count();
         state.counters["Throughput_Mops"] = (LOOP / elapsed.count()) * 1e3;
+        state.counters["allocs_per_then"] = static_cast<double>(allocs) / LOOP;
 
     }
 }
@@ -350,6 +400,742 @@ BENCHMARK(BM_Then_Chain_1_000_000)
     ->Unit(benchmark::kMillisecond);
 
 
+// Fork-join recursion from the README: every level spawns two children and joins them
+// with when_all().then(), so workers constantly run dry and steal from each other.
+static rts::async::Future<int> bench_fibonacci(int n) {
+    if (n <= 1) {
+        return rts::async::spawn([n] { return n; });
+    }
+    auto f1 = bench_fibonacci(n - 1);
+    auto f2 = bench_fibonacci(n - 2);
+    return rts::async::when_all(std::move(f1), std::move(f2))
+        .then([](std::tuple<int, int> results) {
+            auto [a, b] = results;
+            return a + b;
+        });
+}
+
+// Measures the time to compute fibonacci(N) as a tree of tasks.
+static void BM_Fibonacci_Fork_Join(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads    = static_cast<size_t>(state.range(0));
+    const auto queue_capacity = static_cast<size_t>(state.range(1));
+    constexpr int N           = 22;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, queue_capacity);
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+        int result = bench_fibonacci(N).get();
+        auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Threads"]       = num_threads;
+        state.counters["QueueCapacity"] = queue_capacity;
+        state.counters["Fib_N"]         = N;
+        state.counters["Total_ms"]      = elapsed.count();
+    }
+}
+
+// Register (num_threads, queue_capacity)
+BENCHMARK(BM_Fibonacci_Fork_Join)
+    ->ArgsProduct({{1, 2, 3, 4}, {1 << 10}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// The same recursion as a coroutine: each level co_awaits its two children
+// instead of combining their Futures with when_all().then().
+static rts::async::task<int> bench_fibonacci_coroutine(int n) {
+    if (n <= 1) {
+        co_return n;
+    }
+    auto t1 = bench_fibonacci_coroutine(n - 1);
+    auto t2 = bench_fibonacci_coroutine(n - 2);
+    co_return co_await t1 + co_await t2;
+}
+
+// Measures the time to compute fibonacci(N) as a tree of coroutines.
+static void BM_Fibonacci_Coroutine(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads    = static_cast<size_t>(state.range(0));
+    const auto queue_capacity = static_cast<size_t>(state.range(1));
+    constexpr int N           = 22;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, queue_capacity);
+        state.ResumeTiming();
+
+        const uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        int result = bench_fibonacci_coroutine(N).get();
+        auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        const uint64_t allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Threads"]       = num_threads;
+        state.counters["QueueCapacity"] = queue_capacity;
+        state.counters["Fib_N"]         = N;
+        state.counters["Total_ms"]      = elapsed.count();
+        state.counters["heap_allocs"]   = static_cast<double>(allocs);
+    }
+}
+
+// Register (num_threads, queue_capacity)
+BENCHMARK(BM_Fibonacci_Coroutine)
+    ->ArgsProduct({{1, 2, 3, 4}, {1 << 10}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Measures the fan-in of when_all() over a range: every worker fulfills a contiguous slice
+// of `width` promises, and each completion arrives on the join's counter. Compares a single
+// flat counter (fan_in = 0 below) with a CombiningTree of the given fan-in.
+static void BM_When_All_Fan_In(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto width       = static_cast<size_t>(state.range(0));
+    const auto fan_in      = state.range(1) == 0 ? SIZE_MAX : static_cast<size_t>(state.range(1));
+    const auto num_threads = rts::core::kDefaultWorkerCount;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, 1 << 10);
+
+        std::vector<rts::async::Promise<int>> promises(width);
+        std::vector<rts::async::Future<int>> futures;
+        futures.reserve(width);
+        for (auto& p : promises)
+            futures.push_back(p.get_future());
+        auto all = rts::async::when_all(futures, fan_in);
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t w = 0; w < num_threads; ++w) {
+            rts::async::spawn([&promises, w, width, num_threads] {
+                for (size_t i = w * width / num_threads; i < (w + 1) * width / num_threads; ++i)
+                    promises[i].set_value(static_cast<int>(i));
+            });
+        }
+        auto values = all.get();
+        auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(values.data());
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Threads"]      = num_threads;
+        state.counters["Width"]        = width;
+        state.counters["FanIn"]        = state.range(1);
+        state.counters["ns_per_input"] = elapsed.count() / width;
+    }
+}
+
+// Register (width, fan_in), fan_in 0 = flat counter
+BENCHMARK(BM_When_All_Fan_In)
+    ->ArgsProduct({{16, 256, 1 << 12, 1 << 16, 1 << 20}, {0, 16, 64}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Measures a 1M-iteration loop of cheap bodies with parallel_for() (grain > 0) against the
+// hand-rolled alternative of spawning one task per 1024 iterations and joining the Futures
+// (grain = -1 below), reporting the heap allocations of each. Grain 0 is automatic.
+static void BM_Parallel_For_1_000_000(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads = static_cast<size_t>(state.range(0));
+    const bool hand_rolled = state.range(1) < 0;
+    const auto grain       = static_cast<size_t>(std::max<int64_t>(state.range(1), 0));
+    constexpr int LOOP     = 1'000'000;
+    constexpr int CHUNK    = 1024;
+
+    std::vector<double> data(LOOP, 1.0);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, 1 << 10);
+        state.ResumeTiming();
+
+        const uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        if (!hand_rolled) {
+            rts::parallel_for(0, LOOP, [&data](int i) { data[i] = data[i] * 1.000001 + 0.5; }, grain);
+        } else {
+            std::vector<rts::async::Future<void>> chunks;
+            for (int b = 0; b < LOOP; b += CHUNK) {
+                const int e = std::min(b + CHUNK, LOOP);
+                chunks.push_back(rts::async::spawn([&data, b, e] {
+                    for (int i = b; i < e; ++i)
+                        data[i] = data[i] * 1.000001 + 0.5;
+                }));
+            }
+            rts::async::when_all(chunks).get();
+        }
+        auto end = std::chrono::steady_clock::now();
+        const uint64_t allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+        benchmark::DoNotOptimize(data.data());
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Threads"]     = num_threads;
+        state.counters["Grain"]       = static_cast<double>(state.range(1));
+        state.counters["ns_per_iter"] = elapsed.count() / LOOP;
+        state.counters["heap_allocs"] = static_cast<double>(allocs);
+    }
+}
+
+// Register (num_threads, grain), grain -1 = one spawn() per 1024 iterations
+BENCHMARK(BM_Parallel_For_1_000_000)
+    ->ArgsProduct({{1, 2, 4}, {-1, 0, 1, 64, 1024}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Measures the sum of 1M doubles with parallel_reduce() (mode 0) against the hand-rolled
+// alternative of one Future<double> per 1024 elements combined with when_all() (mode 1).
+static void BM_Parallel_Reduce_1_000_000(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads = static_cast<size_t>(state.range(0));
+    const bool hand_rolled = state.range(1) != 0;
+    constexpr int LOOP     = 1'000'000;
+    constexpr int CHUNK    = 1024;
+
+    std::vector<double> data(LOOP, 0.5);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, 1 << 10);
+        state.ResumeTiming();
+
+        const uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        double sum = 0.0;
+        if (!hand_rolled) {
+            sum = rts::parallel_reduce(data, 0.0, std::plus<>{}, std::plus<>{});
+        } else {
+            std::vector<rts::async::Future<double>> chunks;
+            for (int b = 0; b < LOOP; b += CHUNK) {
+                const int e = std::min(b + CHUNK, LOOP);
+                chunks.push_back(rts::async::spawn([&data, b, e] {
+                    double partial = 0.0;
+                    for (int i = b; i < e; ++i)
+                        partial += data[i];
+                    return partial;
+                }));
+            }
+            for (double partial : rts::async::when_all(chunks).get())
+                sum += partial;
+        }
+        auto end = std::chrono::steady_clock::now();
+        const uint64_t allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+        benchmark::DoNotOptimize(sum);
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Threads"]     = num_threads;
+        state.counters["HandRolled"]  = hand_rolled;
+        state.counters["ns_per_elem"] = elapsed.count() / LOOP;
+        state.counters["heap_allocs"] = static_cast<double>(allocs);
+    }
+}
+
+// Register (num_threads, mode)
+BENCHMARK(BM_Parallel_Reduce_1_000_000)
+    ->ArgsProduct({{1, 2, 4}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Runs a standard algorithm over 4M doubles sequentially (backend 0), with rts::execution::par
+// (backend 1) and with std::execution::par (backend 2, only when built against TBB).
+// Algorithms: 0 = for_each, 1 = transform, 2 = reduce.
+static void BM_Execution_Policy_4M(benchmark::State &state) {
+    pin_to_core(5);
+
+    const int algorithm    = static_cast<int>(state.range(0));
+    const int backend      = static_cast<int>(state.range(1));
+    const auto num_threads = static_cast<size_t>(state.range(2));
+    constexpr size_t SIZE  = size_t{1} << 22;
+
+#if !MINIRTS_BENCH_STD_PAR
+    if (backend == 2) {
+        state.SkipWithMessage("std::execution::par requires TBB");
+        return;
+    }
+#endif
+
+    std::vector<double> in(SIZE, 1.5);
+    std::vector<double> out(SIZE);
+    auto body = [](double x) { return x * 1.000001 + 0.5; };
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, 1 << 10);
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+        double sum = 0.0;
+        switch (backend * 3 + algorithm) {
+            case 0: std::for_each(in.begin(), in.end(), [&](double& x) { x = body(x); }); break;
+            case 1: std::transform(in.begin(), in.end(), out.begin(), body); break;
+            case 2: sum = std::reduce(in.begin(), in.end(), 0.0); break;
+            case 3: rts::for_each(rts::execution::par, in.begin(), in.end(), [&](double& x) { x = body(x); }); break;
+            case 4: rts::transform(rts::execution::par, in.begin(), in.end(), out.begin(), body); break;
+            case 5: sum = rts::reduce(rts::execution::par, in.begin(), in.end(), 0.0); break;
+#if MINIRTS_BENCH_STD_PAR
+            case 6: std::for_each(std::execution::par, in.begin(), in.end(), [&](double& x) { x = body(x); }); break;
+            case 7: std::transform(std::execution::par, in.begin(), in.end(), out.begin(), body); break;
+            case 8: sum = std::reduce(std::execution::par, in.begin(), in.end(), 0.0); break;
+#endif
+            default: break;
+        }
+        auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(out.data());
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Algorithm"]   = algorithm;
+        state.counters["Backend"]     = backend;
+        state.counters["Threads"]     = num_threads;
+        state.counters["ns_per_elem"] = elapsed.count() / SIZE;
+    }
+}
+
+// Register (algorithm, backend, num_threads); num_threads only applies to MiniRTS
+BENCHMARK(BM_Execution_Policy_4M)
+    ->ArgsProduct({{0, 1, 2}, {0, 1, 2}, {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Sorts `size` random 32-bit keys with std::sort (backend 0), rts::parallel_sort (backend 1)
+// and std::sort(std::execution::par) (backend 2, only when built against TBB). The input is
+// refilled from a pristine copy outside the timed region. Reports ns per element.
+static void BM_Parallel_Sort(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto size        = static_cast<size_t>(state.range(0));
+    const int backend      = static_cast<int>(state.range(1));
+    const auto num_threads = static_cast<size_t>(state.range(2));
+
+#if !MINIRTS_BENCH_STD_PAR
+    if (backend == 2) {
+        state.SkipWithMessage("std::execution::par requires TBB");
+        return;
+    }
+#endif
+
+    std::mt19937 rng(7);
+    std::vector<uint32_t> input(size);
+    for (auto& key : input)
+        key = static_cast<uint32_t>(rng());
+    std::vector<uint32_t> keys(size);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), keys.begin());
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, 1 << 10);
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+        switch (backend) {
+            case 0: std::sort(keys.begin(), keys.end()); break;
+            case 1: rts::parallel_sort(keys.begin(), keys.end()); break;
+#if MINIRTS_BENCH_STD_PAR
+            case 2: std::sort(std::execution::par, keys.begin(), keys.end()); break;
+#endif
+            default: break;
+        }
+        auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(keys.data());
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Size"]        = static_cast<double>(size);
+        state.counters["Backend"]     = backend;
+        state.counters["Threads"]     = num_threads;
+        state.counters["ns_per_elem"] = elapsed.count() / static_cast<double>(size);
+    }
+}
+
+// Register (size, backend, num_threads); num_threads only applies to MiniRTS
+BENCHMARK(BM_Parallel_Sort)
+    ->ArgsProduct({{1'000'000, 10'000'000, 100'000'000}, {0, 1, 2}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Runs a two-pass blocked primitive over 16M 64-bit integers sequentially (backend 0), with
+// MiniRTS (backend 1) and with std::execution::par (backend 2, only when built against TBB).
+// Algorithms: 0 = inclusive_scan, 1 = copy_if (half the elements kept), 2 = stable partition.
+static void BM_Parallel_Scan_16M(benchmark::State &state) {
+    pin_to_core(5);
+
+    const int algorithm    = static_cast<int>(state.range(0));
+    const int backend      = static_cast<int>(state.range(1));
+    const auto num_threads = static_cast<size_t>(state.range(2));
+    constexpr size_t SIZE  = size_t{1} << 24;
+
+#if !MINIRTS_BENCH_STD_PAR
+    if (backend == 2) {
+        state.SkipWithMessage("std::execution::par requires TBB");
+        return;
+    }
+#endif
+
+    std::mt19937_64 rng(11);
+    std::vector<int64_t> input(SIZE);
+    for (auto& x : input)
+        x = static_cast<int64_t>(rng() % 1000);
+    std::vector<int64_t> data(SIZE);
+    std::vector<int64_t> out(SIZE);
+    auto odd = [](int64_t x) { return (x & 1) != 0; };
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), data.begin());
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, 1 << 10);
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+        switch (backend * 3 + algorithm) {
+            case 0: std::inclusive_scan(data.begin(), data.end(), out.begin()); break;
+            case 1: std::copy_if(data.begin(), data.end(), out.begin(), odd); break;
+            case 2: std::stable_partition(data.begin(), data.end(), odd); break;
+            case 3: rts::parallel_inclusive_scan(data.begin(), data.end(), out.begin()); break;
+            case 4: rts::parallel_copy_if(data.begin(), data.end(), out.begin(), odd); break;
+            case 5: rts::parallel_partition(data.begin(), data.end(), odd); break;
+#if MINIRTS_BENCH_STD_PAR
+            case 6: std::inclusive_scan(std::execution::par, data.begin(), data.end(), out.begin()); break;
+            case 7: std::copy_if(std::execution::par, data.begin(), data.end(), out.begin(), odd); break;
+            case 8: std::stable_partition(std::execution::par, data.begin(), data.end(), odd); break;
+#endif
+            default: break;
+        }
+        auto end = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(data.data());
+        benchmark::DoNotOptimize(out.data());
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Algorithm"]   = algorithm;
+        state.counters["Backend"]     = backend;
+        state.counters["Threads"]     = num_threads;
+        state.counters["ns_per_elem"] = elapsed.count() / SIZE;
+    }
+}
+
+// Register (algorithm, backend, num_threads); num_threads only applies to MiniRTS
+BENCHMARK(BM_Parallel_Scan_16M)
+    ->ArgsProduct({{0, 1, 2}, {0, 1, 2}, {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Runs a layered pipeline of 8 layers x 8 nodes, each node depending on every node of the
+// previous layer, 1'000 times per iteration. Mode 0 declares an rts::graph::Graph once and
+// reruns it; mode 1 rebuilds the DAG every run out of spawn + when_all + then.
+// Reports the heap allocations per pipeline run.
+static void BM_Task_Graph(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads = static_cast<size_t>(state.range(0));
+    const int mode         = static_cast<int>(state.range(1));
+    constexpr int WIDTH = 8, DEPTH = 8, RUNS = 1'000;
+
+    std::atomic<uint64_t> work {0};
+    auto node_work = [&work] { work.fetch_add(1, std::memory_order_relaxed); };
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, 1 << 10);
+
+        rts::graph::Graph graph;
+        std::vector<rts::graph::Node> nodes;
+        for (int layer = 0; layer < DEPTH; ++layer) {
+            for (int i = 0; i < WIDTH; ++i) {
+                nodes.push_back(graph.emplace(node_work));
+                for (int j = 0; layer > 0 && j < WIDTH; ++j)
+                    nodes[(layer - 1) * WIDTH + j].precede(nodes.back());
+            }
+        }
+        if (mode == 0)
+            graph.run().get();  // Prepares the graph and warms up the slabs.
+        state.ResumeTiming();
+
+        const uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < RUNS; ++run) {
+            if (mode == 0) {
+                graph.run().get();
+                continue;
+            }
+            std::vector<rts::async::Future<void>> previous, current;
+            for (int layer = 0; layer < DEPTH; ++layer) {
+                current.clear();
+                if (layer == 0) {
+                    for (int i = 0; i < WIDTH; ++i)
+                        current.push_back(rts::async::spawn(node_work));
+                } else {
+                    auto barrier = rts::async::when_all(previous);
+                    for (int i = 0; i < WIDTH; ++i)
+                        current.push_back(barrier.then(node_work));
+                }
+                std::swap(previous, current);
+            }
+            rts::async::when_all(previous).get();
+        }
+        auto end = std::chrono::steady_clock::now();
+        const uint64_t allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Threads"]        = num_threads;
+        state.counters["Mode"]           = mode;
+        state.counters["allocs_per_run"] = static_cast<double>(allocs) / RUNS;
+        state.counters["ns_per_run"]     = elapsed.count() / RUNS;
+    }
+    benchmark::DoNotOptimize(work.load());
+}
+
+// Register (num_threads, mode)
+BENCHMARK(BM_Task_Graph)
+    ->ArgsProduct({{1, 2, 4}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Runs the fibonacci fork-join and reports which StealTier the successful steals came from
+// (SMT sibling, shared L3, same NUMA node, remote), as a share of all steals.
+static void BM_Steal_Tier_Usage(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads    = static_cast<size_t>(state.range(0));
+    const auto queue_capacity = static_cast<size_t>(state.range(1));
+    constexpr int N           = 22;
+
+    std::array<uint64_t, rts::core::kStealTiers> before {};
+    for (size_t tier = 0; tier < rts::core::kStealTiers; ++tier)
+        before[tier] = rts::core::steals_per_tier[tier].load();
+
+    for (auto _ : state) {
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, queue_capacity);
+        benchmark::DoNotOptimize(bench_fibonacci(N).get());
+        rts::finalize_soft();
+    }
+
+    std::array<double, rts::core::kStealTiers> steals {};
+    double total = 0;
+    for (size_t tier = 0; tier < rts::core::kStealTiers; ++tier) {
+        steals[tier] = static_cast<double>(rts::core::steals_per_tier[tier].load() - before[tier]);
+        total += steals[tier];
+    }
+    const double denom = total > 0 ? total : 1;
+
+    state.counters["Threads"]      = num_threads;
+    state.counters["Steals"]       = benchmark::Counter(total, benchmark::Counter::kAvgIterations);
+    state.counters["SMT_pct"]      = 100 * steals[rts::core::SMT_TIER] / denom;
+    state.counters["L3_pct"]       = 100 * steals[rts::core::CACHE_TIER] / denom;
+    state.counters["NUMA_pct"]     = 100 * steals[rts::core::NUMA_TIER] / denom;
+    state.counters["Remote_pct"]   = 100 * steals[rts::core::REMOTE_TIER] / denom;
+}
+
+// Register (num_threads, queue_capacity) up to the machine's worker count.
+BENCHMARK(BM_Steal_Tier_Usage)
+    ->Apply(register_topology_args)
+    ->Unit(benchmark::kMillisecond);
+
+
+// Measures the latency of waking an idle runtime with a single task, for each IdleMode.
+// Before every task the submitting thread sleeps long enough for PARK_IDLE workers to park,
+// so the latency includes the futex wake-up. SPIN_IDLE is the always-spinning baseline.
+// Also reports the CPU time burned by the process while the runtime sits idle.
+static void BM_Wake_Latency(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads    = static_cast<size_t>(state.range(0));
+    const auto queue_capacity = static_cast<size_t>(state.range(1));
+    const auto idle_mode      = static_cast<rts::core::IdleMode>(state.range(2));
+    constexpr int LOOP = 1'000;
+    constexpr auto IDLE_PERIOD = std::chrono::milliseconds(2);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, queue_capacity, idle_mode);
+        state.ResumeTiming();
+
+        double total_ns = 0.0;
+        const auto wall_start = std::chrono::steady_clock::now();
+        const std::clock_t cpu_start = std::clock();
+
+        for (int i = 0; i < LOOP; ++i) {
+            std::this_thread::sleep_for(IDLE_PERIOD);
+
+            std::atomic<int> flag{0};
+            const auto start = std::chrono::steady_clock::now();
+            rts::enqueue([&flag] {
+                flag.store(1, std::memory_order_release);
+            });
+
+            while (!flag.load(std::memory_order_acquire)) {}
+            const auto end = std::chrono::steady_clock::now();
+            total_ns += std::chrono::duration<double, std::nano>(end - start).count();
+        }
+
+        const std::clock_t cpu_end = std::clock();
+        const auto wall_end = std::chrono::steady_clock::now();
+
+        state.PauseTiming();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        const double wall_s = std::chrono::duration<double>(wall_end - wall_start).count();
+        const double cpu_s  = static_cast<double>(cpu_end - cpu_start) / CLOCKS_PER_SEC;
+
+        state.counters["Threads"]         = static_cast<double>(num_threads);
+        state.counters["QueueCapacity"]   = static_cast<double>(queue_capacity);
+        state.counters["IdleMode"]        = static_cast<double>(idle_mode);
+        state.counters["avg_wake_latency"] = total_ns / LOOP;
+        state.counters["cores_busy"]      = cpu_s / wall_s;
+    }
+}
+
+BENCHMARK(BM_Wake_Latency)
+    ->Apply(register_idle_args)
+    ->Unit(benchmark::kMillisecond);
+
+
+// Measures the distribution of scheduling latencies under load: 1 million empty tasks are
+// submitted with enqueue() and 1 million with spawn() as fast as possible, and the runtime's
+// own histograms give the percentiles of enqueue-to-start and spawn-to-ready (in ns).
+// Only reports percentiles when built with MINIRTS_LATENCY_STATS=ON.
+static void BM_Latency_Distribution_Under_Load(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads    = static_cast<size_t>(state.range(0));
+    const auto queue_capacity = static_cast<size_t>(state.range(1));
+    constexpr int LOOP = 1'000'000;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, queue_capacity);
+        state.ResumeTiming();
+
+        std::atomic<int> done{0};
+        for (int i = 0; i < LOOP; ++i) {
+            rts::enqueue([&done] {
+                done.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        for (int i = 0; i < LOOP; ++i) {
+            benchmark::DoNotOptimize(rts::async::spawn([] {}));
+        }
+        while (done.load(std::memory_order_relaxed) != LOOP) {}
+
+        state.PauseTiming();
+        const rts::core::LatencyStats latency = rts::latency_stats();
+        rts::finalize_soft();
+        state.ResumeTiming();
+
+        state.counters["Threads"]       = static_cast<double>(num_threads);
+        state.counters["QueueCapacity"] = static_cast<double>(queue_capacity);
+        report_percentiles(state, "enqueue_to_start", latency.enqueue_to_start);
+        report_percentiles(state, "spawn_to_ready", latency.spawn_to_ready);
+    }
+}
+
+BENCHMARK(BM_Latency_Distribution_Under_Load)
+    ->Apply(register_args)
+    ->Unit(benchmark::kMillisecond);
+
+
+// Measures submission throughput when several threads call enqueue() concurrently.
+// 1 million empty tasks are split evenly across the producers; the timed region spans
+// from releasing the producers until every task has run.
+static void BM_Enqueue_Contention_1_000_000(benchmark::State &state) {
+    pin_to_core(5);
+
+    const auto num_threads    = static_cast<size_t>(state.range(0));
+    const auto queue_capacity = static_cast<size_t>(state.range(1));
+    const auto num_producers  = static_cast<int>(state.range(2));
+    constexpr int LOOP = 1'000'000;
+    const int per_producer = LOOP / num_producers;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+
+        rts::initialize_runtime<rts::core::DefaultThreadPool>(num_threads, queue_capacity);
+
+        std::latch start_line(num_producers + 1);
+        std::vector<std::thread> producers;
+        producers.reserve(num_producers);
+        for (int p = 0; p < num_producers; ++p) {
+            producers.emplace_back([&start_line, per_producer] {
+                start_line.arrive_and_wait();
+                for (int i = 0; i < per_producer; ++i) {
+                    rts::enqueue([] {});
+                }
+            });
+        }
+
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+
+        start_line.arrive_and_wait();
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        rts::finalize_soft();
+
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        const double total_tasks = static_cast<double>(per_producer) * num_producers;
+
+        state.counters["Threads"]         = num_threads;
+        state.counters["QueueCapacity"]   = queue_capacity;
+        state.counters["Producers"]       = num_producers;
+        state.counters["ns_per_task"]     = elapsed.count() / total_tasks;
+        state.counters["Throughput_Mops"] = (total_tasks / elapsed.count()) * 1e3;
+    }
+}
+
+BENCHMARK(BM_Enqueue_Contention_1_000_000)
+    ->Apply(register_producer_args)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+
 /*
 // Measures the direct cost of attaching a continuation via .then()
 // Excludes task creation and Promise overhead.
@@ -433,4 +1219,17 @@ BENCHMARK(BM_Then_Registration_1_000_000)
     ->Unit(benchmark::kMillisecond);
     */
 
+#if MINIRTS_PROFILE
+// Profile builds print the scheduler overhead breakdown after every benchmark.
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    ProfileReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+    return 0;
+}
+#else
 BENCHMARK_MAIN();
+#endif
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <string>
+#include <vector>
 #include <benchmark/benchmark.h>
 
 #if defined(_MSC_VER)
@@ -11,14 +14,6 @@
 #endif
 
 
-inline bool is_tsc_invariant() {
-    unsigned int eax, ebx, ecx, edx;
-    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
-        return false;
-    return edx & (1 << 8); // Bit 8 of EDX means invariant TSC
-}
-
-
 // Calculates how many iterations of a busy loop amount to target_ns.
 inline int calibrate_busy_work(int target_ns = 1000) {
     int iter = 1'000'000'000;
@@ -50,3 +45,54 @@ inline void register_args(benchmark::internal::Benchmark *b) {
         }
     }
 }
+
+
+// Registers (num_threads, queue_capacity, idle_mode) for every IdleMode.
+inline void register_idle_args(benchmark::internal::Benchmark *b) {
+    for (int threads = 1; threads <= 4; threads += 1) {
+        for (auto mode : {rts::core::SPIN_IDLE, rts::core::PARK_IDLE}) {
+            b->Args({threads, 1 << 10, mode});
+        }
+    }
+}
+
+
+// Registers (num_threads, queue_capacity, num_producers) with 1 to 16 producer threads.
+inline void register_producer_args(benchmark::internal::Benchmark *b) {
+    for (int threads = 1; threads <= 4; threads += 1) {
+        for (int producers = 1; producers <= 16; producers *= 2) {
+            b->Args({threads, 1 << 12, producers});
+        }
+    }
+}
+
+
+// Registers (num_threads, queue_capacity) with num_threads doubling up to the machine's worker count.
+inline void register_topology_args(benchmark::internal::Benchmark *b) {
+    for (size_t threads = 2; threads < rts::core::kDefaultWorkerCount; threads *= 2) {
+        b->Args({static_cast<int64_t>(threads), 1 << 10});
+    }
+    b->Args({static_cast<int64_t>(std::max<size_t>(rts::core::kDefaultWorkerCount, 2)), 1 << 10});
+}
+
+
+// Reports the p50/p99/p99.9 (ns) of a latency distribution as counters named `<name>_p50`, ...
+inline void report_percentiles(benchmark::State &state, const std::string &name,
+                               const rts::core::LatencyDistribution &distribution) {
+    state.counters[name + "_p50"]  = distribution.percentile(50);
+    state.counters[name + "_p99"]  = distribution.percentile(99);
+    state.counters[name + "_p999"] = distribution.percentile(99.9);
+}
+
+
+// Console reporter that also prints, after every benchmark, how the workers of the runtimes
+// it started split their time between the phases of their scheduling loop (MINIRTS_PROFILE).
+class ProfileReporter : public benchmark::ConsoleReporter {
+public:
+    void ReportRuns(const std::vector<Run> &runs) override {
+        ConsoleReporter::ReportRuns(runs);
+        const rts::core::ProfileReport report = rts::core::take_exited_profile();
+        if (!report.workers.empty())
+            rts::core::write_profile_report(GetOutputStream(), report);
+    }
+};
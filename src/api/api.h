@@ -7,4 +7,12 @@
 #include "future.h"
 #include "spawn.h"
 #include "when_all.h"
-#include "when_any.h"
\ No newline at end of file
+#include "when_any.h"
+#include "coroutine.h"
+#include "parallel_for.h"
+#include "parallel_reduce.h"
+#include "parallel_invoke.h"
+#include "parallel_sort.h"
+#include "parallel_scan.h"
+#include "task_graph.h"
+#include "execution.h"
\ No newline at end of file
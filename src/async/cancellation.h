@@ -0,0 +1,131 @@
+/**
+ * @file cancellation.h
+ * @brief Cooperative cancellation: CancellationSource, CancellationToken and TaskCancelled.
+ *
+ * A token is attached to a task with `spawn(token, f, args...)` and inherited by every
+ * `then()` continuation chained on its Future. Once the source requests cancellation,
+ * tasks carrying the token are dropped when a worker dequeues them: the callable is not
+ * invoked and its Future fails with TaskCancelled. Work that already started is not
+ * interrupted; long-running callables may poll the token themselves.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+
+#include "state_ref.h"
+
+namespace rts::async {
+
+    /**
+     * @brief Exception stored in the Future of a task dropped because of cancellation.
+     */
+    class TaskCancelled : public std::exception {
+    public:
+        [[nodiscard]] const char* what() const noexcept override {
+            return "rts::async::TaskCancelled";
+        }
+    };
+
+    /**
+     * @brief Cancellation flag shared by a CancellationSource and its tokens.
+     */
+    class CancellationState {
+        std::atomic<uint32_t> refs_{1};         ///< Number of StateRefs owning the state.
+        std::atomic<bool> cancelled_{false};    ///< Set once cancellation is requested.
+
+        template <typename S>
+        friend class StateRef;
+
+        friend class CancellationSource;
+        friend class CancellationToken;
+    };
+
+    /**
+     * @brief Read-only view of a cancellation request.
+     *
+     * A default-constructed token can never be cancelled and costs nothing to check.
+     */
+    class CancellationToken {
+        StateRef<CancellationState> state_;
+
+        explicit CancellationToken(StateRef<CancellationState> state) noexcept
+            : state_(std::move(state)) {}
+
+        friend class CancellationSource;
+
+    public:
+        CancellationToken() noexcept = default;
+
+        /**
+         * @brief Returns true once the associated source has requested cancellation.
+         */
+        [[nodiscard]] bool is_cancelled() const noexcept {
+            return state_ && state_->cancelled_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Returns true if the token is associated with a source.
+         */
+        [[nodiscard]] bool can_be_cancelled() const noexcept {
+            return static_cast<bool>(state_);
+        }
+
+        /**
+         * @brief Tokens are equal if they observe the same source (or none).
+         */
+        friend bool operator==(const CancellationToken& a, const CancellationToken& b) noexcept {
+            return a.state_.get() == b.state_.get();
+        }
+    };
+
+    /**
+     * @brief Owner of a cancellation request, handing out tokens that observe it.
+     */
+    class CancellationSource {
+        StateRef<CancellationState> state_;
+
+        explicit CancellationSource(StateRef<CancellationState> state) noexcept
+            : state_(std::move(state)) {}
+
+    public:
+        /// @brief Creates a source with a fresh, not yet cancelled, state.
+        CancellationSource()
+            : state_(StateRef<CancellationState>::make()) {}
+
+        /**
+         * @brief Returns a source controlling the same request as `token`.
+         *
+         * Used by combinators (e.g. `when_any(cancel_losers, ...)`) that cancel work they
+         * were handed the tokens of. Returns a source without a state for a default token.
+         */
+        [[nodiscard]] static CancellationSource from(const CancellationToken& token) noexcept {
+            return CancellationSource(token.state_);
+        }
+
+        /**
+         * @brief Returns a token observing this source.
+         */
+        [[nodiscard]] CancellationToken token() const noexcept {
+            return CancellationToken(state_);
+        }
+
+        /**
+         * @brief Requests cancellation. Tasks carrying the token that have not started yet are dropped.
+         */
+        void request_cancellation() const noexcept {
+            if (state_)
+                state_->cancelled_.store(true, std::memory_order_release);
+        }
+
+        /**
+         * @brief Returns true once cancellation has been requested.
+         */
+        [[nodiscard]] bool is_cancellation_requested() const noexcept {
+            return state_ && state_->cancelled_.load(std::memory_order_acquire);
+        }
+    };
+
+} // namespace rts::async
@@ -0,0 +1,216 @@
+/**
+ * @file coroutine.h
+ * @brief C++20 coroutine support: the `task<T>` coroutine type and `co_await` on Futures.
+ *
+ * A coroutine returning `rts::async::task<T>` starts on a MiniRTS worker and may
+ * `co_await` any Future (or other task) without blocking that worker: it is suspended,
+ * registered as a continuation of the awaited Future, and resumed by the worker that
+ * fulfills it. Coroutine frames are allocated from the per-thread SlabAllocator.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+#include "concepts.h"
+#include "future.h"
+#include "promise.h"
+#include "slab_allocator.h"
+#include "task.h"
+#include "worker.h"
+
+namespace rts::async {
+
+    /**
+     * @brief Awaiter suspending a coroutine until a Future is ready.
+     *
+     * The coroutine is resumed by the worker that fulfills the Future, like any other
+     * continuation: inline (see kMaxInlineContinuationDepth) or from that worker's WSQ.
+     *
+     * @tparam T The value type of the awaited Future.
+     */
+    template<typename T>
+    class FutureAwaiter {
+        Future<T> future_;
+
+    public:
+        explicit FutureAwaiter(Future<T> future) noexcept
+            : future_(std::move(future)) {}
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return future_.is_ready();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            core::Task resume([handle] { handle.resume(); });
+            // Once registered, the coroutine (and this awaiter) may be resumed and destroyed
+            // by another worker at any time: do not touch members afterwards.
+            return future_.try_register(resume);
+        }
+
+        T await_resume() {
+            return future_.get();
+        }
+    };
+
+    /**
+     * @brief Makes every Future awaitable from a coroutine.
+     */
+    template<typename T>
+    FutureAwaiter<T> operator co_await(Future<T> future) noexcept {
+        return FutureAwaiter<T>(std::move(future));
+    }
+
+    /**
+     * @brief Awaiter that moves the awaiting coroutine onto the runtime.
+     *
+     * On a worker, the coroutine is pushed to the worker's WSQ (where other workers may
+     * steal it); from any other thread, it is submitted with rts::enqueue().
+     */
+    struct ScheduleAwaiter {
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) const noexcept {
+            core::Task resume([handle] { handle.resume(); });
+            if (core::tls_worker)
+                core::tls_worker->enqueue_local(std::move(resume));
+            else
+                rts::enqueue(std::move(resume));
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Returns an awaitable that reschedules the current coroutine on the runtime.
+     */
+    [[nodiscard]] inline ScheduleAwaiter schedule() noexcept {
+        return {};
+    }
+
+    template<typename T>
+    requires rts::core::concepts::FutureValue<T>
+    class task;
+
+    /**
+     * @brief Promise-type members shared by every `task<T>`.
+     *
+     * The coroutine result is published through a regular Promise<T>, so a task is
+     * observed exactly like a Future. The frame destroys itself once the body returns.
+     */
+    template<typename T>
+    struct TaskPromiseBase {
+        Promise<T> promise;     ///< Fulfilled when the coroutine body returns or throws.
+
+        /// @brief Tasks start on a worker, never on the calling thread.
+        [[nodiscard]] ScheduleAwaiter initial_suspend() const noexcept { return {}; }
+
+        [[nodiscard]] std::suspend_never final_suspend() const noexcept { return {}; }
+
+        void unhandled_exception() noexcept {
+            promise.set_exception(std::current_exception());
+        }
+
+        /**
+         * @brief Allocates the coroutine frame from the calling thread's slab.
+         * @note Frames above kMaxSlabBlockSize (2 KiB) use operator new.
+         */
+        static void* operator new(std::size_t size) {
+            return core::SlabAllocator::allocate_bytes(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        }
+
+        static void operator delete(void* frame, std::size_t size) noexcept {
+            core::SlabAllocator::deallocate_bytes(frame, size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        }
+    };
+
+    /**
+     * @brief Promise type of `task<T>`.
+     */
+    template<typename T>
+    struct TaskPromise : TaskPromiseBase<T> {
+        task<T> get_return_object() noexcept;
+
+        void return_value(T value) noexcept {
+            this->promise.set_value(std::move(value));
+        }
+    };
+
+    /**
+     * @brief Specialization for void-returning coroutines.
+     */
+    template<>
+    struct TaskPromise<void> : TaskPromiseBase<void> {
+        task<void> get_return_object() noexcept;
+
+        void return_void() noexcept {
+            promise.set_value();
+        }
+    };
+
+    /**
+     * @brief Coroutine type whose frames run on MiniRTS workers.
+     *
+     * The coroutine starts eagerly on the runtime. Its result can be obtained with
+     * `co_await` from another coroutine, or with get() like a Future (which helps
+     * with other tasks while waiting when called from a worker).
+     *
+     * @tparam T The type produced by `co_return`.
+     */
+    template<typename T>
+    requires rts::core::concepts::FutureValue<T>
+    class task {
+        Future<T> future_;
+
+    public:
+        using value_type   = T;
+        using promise_type = TaskPromise<T>;
+
+        explicit task(Future<T> future) noexcept
+            : future_(std::move(future)) {}
+
+        task(task&&) noexcept = default;
+        task& operator=(task&&) noexcept = default;
+        task(const task&) = delete;
+        task& operator=(const task&) = delete;
+
+        /**
+         * @brief Returns true once the coroutine has returned or thrown.
+         */
+        [[nodiscard]] bool is_ready() const noexcept {
+            return future_.is_ready();
+        }
+
+        /**
+         * @brief Blocks until the coroutine completes, then returns its result or rethrows.
+         */
+        T get() {
+            return future_.get();
+        }
+
+        /**
+         * @brief Returns a Future of the coroutine's result (e.g. to use with then() or when_all()).
+         */
+        [[nodiscard]] Future<T> as_future() const noexcept {
+            return future_;
+        }
+
+        FutureAwaiter<T> operator co_await() const noexcept {
+            return FutureAwaiter<T>(future_);
+        }
+    };
+
+    template<typename T>
+    task<T> TaskPromise<T>::get_return_object() noexcept {
+        return task<T>(this->promise.get_future());
+    }
+
+    inline task<void> TaskPromise<void>::get_return_object() noexcept {
+        return task<void>(promise.get_future());
+    }
+
+} // namespace rts::async
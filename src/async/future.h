@@ -6,15 +6,15 @@
 #pragma once
 
 #include <exception>
-#include <memory>
-#include <mutex>
 #include <type_traits>
 #include <utility>
 
+#include "cancellation.h"
 #include "concepts.h"
 #include "shared_state.h"
 #include "task.h"
 #include "utils.h"
+#include "worker.h"
 
 namespace rts {
     /**
@@ -38,12 +38,25 @@ namespace rts::async {
     template<typename T>
     requires rts::core::concepts::FutureValue<T>
     class Future {
-        std::shared_ptr<SharedState<T>> state_;
+        StateRef<SharedState<T>> state_;
+
+        /**
+         * @brief Registers a continuation, or schedules it right away if the Future is ready:
+         *        on the calling worker's WSQ, or through rts::enqueue() from other threads.
+         */
+        void attach(core::Task&& task) const noexcept {
+            if (state_->try_register(task))
+                return;
+            if (core::tls_worker)
+                core::tls_worker->enqueue_local(std::move(task));
+            else
+                rts::enqueue(std::move(task));
+        }
 
     public:
         using value_type = T;
 
-        explicit Future(std::shared_ptr<SharedState<T>> s)
+        explicit Future(StateRef<SharedState<T>> s)
             : state_(std::move(s)) {
             assert(state_ && "Future constructed with null SharedState");
         }
@@ -53,17 +66,28 @@ namespace rts::async {
          */
         [[nodiscard]] bool is_ready() const noexcept {
             assert(state_ && "is_ready() called on invalid Future");
-            return state_->ready.load(std::memory_order_acquire);
+            return state_->is_ready();
         }
 
         /**
-         * @brief Busy-waits until the Future is ready.
-         *        (Consider replacing with condition_variable later.)
+         * @brief Blocks until the Future is ready.
+         *
+         * On a worker thread, keeps running local, inbox and stolen tasks while waiting,
+         * so tasks may block on the futures of the tasks they spawn. Other threads sleep
+         * until the Promise is fulfilled.
          */
         void wait() const {
             assert(state_ && "wait() called on invalid Future");
-            while (!is_ready()) {
-                // spin
+            if (is_ready())
+                return;
+
+            if (core::Worker* worker = core::tls_worker) {
+                while (!is_ready()) {
+                    if (!worker->help_once())
+                        pause_hint();
+                }
+            } else {
+                state_->wait();
             }
         }
 
@@ -84,6 +108,41 @@ namespace rts::async {
             }
         }
 
+        /**
+         * @brief Returns the cancellation token inherited by continuations of this Future.
+         */
+        [[nodiscard]] const CancellationToken& token() const noexcept {
+            assert(state_ && "token() called on invalid Future");
+            return state_->token;
+        }
+
+        /**
+         * @brief Runs `f(future)` once this Future is ready, whether it holds a value or an exception.
+         *
+         * Unlike then(), `f` always runs (even if the token is cancelled) and no new Future
+         * is created. `f` receives a ready copy of this Future and must not throw.
+         */
+        template<typename F>
+        void on_ready(F&& f) const noexcept
+        requires std::invocable<std::decay_t<F>&, Future&>
+        {
+            assert(state_ && "on_ready() called on invalid Future");
+            attach(core::Task([fut = *this, func = std::forward<F>(f)]() mutable {
+                func(fut);
+            }));
+        }
+
+        /**
+         * @brief Registers a raw continuation without creating a new Future (e.g. to resume a coroutine).
+         *
+         * @param cont Continuation to run once the Future is ready.
+         * @return False if the Future is already ready: `cont` is left to the caller.
+         */
+        bool try_register(core::Task& cont) noexcept {
+            assert(state_ && "try_register() called on invalid Future");
+            return state_->try_register(cont);
+        }
+
         /**
          * @brief Detaches from the shared state, discarding this handle.
          */
@@ -107,12 +166,14 @@ namespace rts::async {
             assert(state_ && "then() called on invalid Future");
 
             using U = std::invoke_result_t<F, T>;
-            Promise<U> p;
+            Promise<U> p(state_->token);
             auto fut_next = p.get_future();
             assert(fut_next.is_ready() == false && "then() returned already-ready future (unexpected)");
 
             auto cont = [s = state_, func = std::forward<F>(f), p = std::move(p)]() mutable {
                 assert(s && "Continuation invoked with null SharedState");
+                if (p.cancel_if_requested())
+                    return;
                 try {
                     if (s->exception)
                         std::rethrow_exception(s->exception);
@@ -133,14 +194,7 @@ namespace rts::async {
                 }
             };
 
-            {
-                std::lock_guard lk(state_->mtx);
-                if (is_ready()) {
-                    rts::enqueue(std::move(cont));
-                } else {
-                    state_->continuations.push_back(std::move(cont));
-                }
-            }
+            attach(core::Task(std::move(cont)));
             return fut_next;
         }
 
@@ -165,11 +219,13 @@ namespace rts::async {
         assert(state_ && "then() called on invalid Future<void>");
         using U = std::invoke_result_t<F>;
 
-        Promise<U> p;
+        Promise<U> p(state_->token);
         auto fut_next = p.get_future();
 
         auto cont = [s = state_, func = std::forward<F>(f), p = std::move(p)]() mutable {
             assert(s && "Continuation invoked with null SharedState<void>");
+            if (p.cancel_if_requested())
+                return;
             try {
                 if (s->exception)
                     std::rethrow_exception(s->exception);
@@ -185,14 +241,7 @@ namespace rts::async {
             }
         };
 
-        {
-            std::lock_guard lk(state_->mtx);
-            if (is_ready()) {
-                rts::enqueue(std::move(cont));
-            } else {
-                state_->continuations.push_back(std::move(cont));
-            }
-        }
+        attach(core::Task(std::move(cont)));
         return fut_next;
     }
 } // namespace rts::async
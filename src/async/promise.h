@@ -12,10 +12,9 @@
 
 #include <cassert>
 #include <exception>
-#include <memory>
-#include <mutex>
 #include <type_traits>
 
+#include "cancellation.h"
 #include "concepts.h"
 #include "shared_state.h"
 #include "future.h"
@@ -39,17 +38,58 @@ namespace rts::async {
      */
     template<typename T>
     class Promise {
-        std::shared_ptr<SharedState<T>> state_;  ///< Shared state between Promise and Future
+        StateRef<SharedState<T>> state_;  ///< Shared state between Promise and Future
+
+        /// @brief Schedules a continuation on the fulfilling worker's WSQ.
+        static void enqueue_local(core::Task&& cont) noexcept {
+            assert(cont && "Continuation is invalid");
+            assert(core::tls_worker && "tls_worker must be set for local enqueue");
+            core::tls_worker->enqueue_local(std::move(cont));
+        }
+
+        /**
+         * @brief Publishes the state and hands its continuations off.
+         *
+         * On a worker below kMaxInlineContinuationDepth, the first continuation runs inline
+         * once the others have been passed to `enqueue`; otherwise all of them are passed to it.
+         */
+        template<typename Enqueue>
+        void fulfill(Enqueue enqueue) noexcept {
+            const bool run_inline = core::tls_worker
+                && core::tls_continuation_depth < core::kMaxInlineContinuationDepth;
+
+            core::Task first;
+            state_->mark_ready([&](core::Task&& cont) noexcept {
+                if (run_inline && !first)
+                    first = cont;
+                else
+                    enqueue(std::move(cont));
+            });
+
+            if (first) {
+                core::WorkerCounters::bump(core::tls_worker->counters().tasks_executed);
+                ++core::tls_continuation_depth;
+                first();
+                first.destroy();
+                --core::tls_continuation_depth;
+            }
+        }
 
     public:
         using value_type = T;
 
-        /// @brief Constructs a new Promise with a fresh shared state.
+        /// @brief Constructs a new Promise with a fresh shared state, allocated from the calling thread's slab.
         Promise() noexcept
-            : state_(std::make_shared<SharedState<T>>()) {
+            : state_(StateRef<SharedState<T>>::make()) {
             assert(state_ && "Promise must have valid SharedState");
         }
 
+        /// @brief Constructs a Promise whose Future, and the continuations chained on it, carry `token`.
+        explicit Promise(CancellationToken token) noexcept
+            : Promise() {
+            state_->token = std::move(token);
+        }
+
         Promise(Promise&& other) noexcept
             : state_(std::move(other.state_)) {}
 
@@ -72,33 +112,48 @@ namespace rts::async {
             return Future<T>(state_);
         }
 
+        /**
+         * @brief Returns the cancellation token carried by this Promise.
+         */
+        [[nodiscard]] const CancellationToken& token() const noexcept {
+            assert(state_ && "token() called on moved-from Promise");
+            return state_->token;
+        }
+
+        /**
+         * @brief Fails the Promise with TaskCancelled if its token was cancelled.
+         *
+         * Called by the task producing the value before doing any work.
+         * @return True if the Promise was failed and the task should be dropped.
+         */
+        bool cancel_if_requested() noexcept {
+            assert(state_ && "cancel_if_requested() called on moved-from Promise");
+            if (!state_->token.is_cancelled()) [[likely]]
+                return false;
+            set_exception(std::make_exception_ptr(TaskCancelled{}));
+            return true;
+        }
+
         /**
          * @brief Sets the result value (non-void case).
          *
          * @tparam U The type of the value being set (defaults to T).
          * @param value The value to store in the shared state.
          *
-         * Notifies all registered continuations once ready.
+         * Notifies all registered continuations once ready, running the first one inline
+         * when called from a worker (see kMaxInlineContinuationDepth).
          */
         template<typename U = T>
         void set_value(U &&value) noexcept requires (!std::is_void_v<U> &&
                                                      core::concepts::PromiseValue<U>) {
             assert(state_ && "set_value() called on moved-from Promise");
 
-            {
-                std::lock_guard lk(state_->mtx);
-                // Prevent double fulfillment
-                assert(!state_->ready.load(std::memory_order_acquire) && "set_value() called twice");
-                state_->value = std::forward<U>(value);
-                state_->ready.store(true, std::memory_order_release);
-            }
+            // Prevent double fulfillment
+            assert(!state_->is_ready() && "set_value() called twice");
+            state_->value = std::forward<U>(value);
 
-            // Schedule all registered continuations
-            for (auto& cont : state_->continuations) {
-                assert(cont && "Continuation is invalid");
-                assert(core::tls_worker && "tls_worker must be set for local enqueue");
-                core::tls_worker->enqueue_local(std::move(cont));
-            }
+            // Publish the value and schedule all registered continuations
+            fulfill(enqueue_local);
         }
 
         /**
@@ -108,17 +163,8 @@ namespace rts::async {
         void set_value() noexcept requires std::is_void_v<U> {
             assert(state_ && "set_value() called on moved-from Promise");
 
-            {
-                std::lock_guard lk(state_->mtx);
-                assert(!state_->ready.load(std::memory_order_acquire) && "set_value() called twice");
-                state_->ready.store(true, std::memory_order_release);
-            }
-
-            for (auto& cont : state_->continuations) {
-                assert(cont && "Continuation is invalid");
-                assert(core::tls_worker && "tls_worker must be set for local enqueue");
-                core::tls_worker->enqueue_local(std::move(cont));
-            }
+            assert(!state_->is_ready() && "set_value() called twice");
+            fulfill(enqueue_local);
         }
 
         /**
@@ -130,17 +176,13 @@ namespace rts::async {
             assert(state_ && "set_exception() called on moved-from Promise");
             assert(e && "set_exception() called with null exception_ptr");
 
-            {
-                std::lock_guard lk(state_->mtx);
-                assert(!state_->ready.load(std::memory_order_acquire) && "set_exception() called twice");
-                state_->exception = std::move(e);
-                state_->ready.store(true, std::memory_order_release);
-            }
+            assert(!state_->is_ready() && "set_exception() called twice");
+            state_->exception = std::move(e);
 
-            for (auto& cont : state_->continuations) {
+            fulfill([](core::Task&& cont) noexcept {
                 assert(cont && "Continuation is invalid");
                 rts::enqueue(std::move(cont));
-            }
+            });
         }
     };
 
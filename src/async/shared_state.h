@@ -6,30 +6,206 @@
 #pragma once
 
 #include <atomic>
-#include <mutex>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <new>
 #include <optional>
-#include <vector>
+#include <utility>
 
+#include "cancellation.h"
+#include "slab_allocator.h"
+#include "state_ref.h"
 #include "task.h"
 
 namespace rts::async {
 
+    /**
+     * @brief Lock-free readiness flag and continuation registry shared by every SharedState.
+     *
+     * The whole state lives in one tagged word:
+     *
+     * | Tag       | Meaning                                                         |
+     * |-----------|-----------------------------------------------------------------|
+     * | `EMPTY`   | Not ready, no continuation.                                     |
+     * | `CLAIMED` | Not ready; a registrant is writing the inline slot.             |
+     * | `ONE`     | Not ready; the inline slot holds a continuation.                |
+     * | `READY`   | Value or exception published; continuations were handed off.    |
+     *
+     * The pointer bits of `CLAIMED` and `ONE` words hold a stack of extra continuations
+     * (slab-allocated nodes) for futures with more than one `then()`. In the common case
+     * (one continuation) registering costs a CAS to claim the inline slot plus a CAS to
+     * publish it, fulfilling costs one exchange, and nothing is allocated.
+     *
+     * The state also carries the intrusive reference count managed by StateRef.
+     */
+    class ContinuationState {
+        /// @brief Continuation beyond the first, chained from the state word.
+        struct alignas(16) Node {
+            core::Task task;
+            Node* next;
+        };
+
+        static constexpr uintptr_t EMPTY   = 0;
+        static constexpr uintptr_t CLAIMED = 1;
+        static constexpr uintptr_t ONE     = 2;
+        static constexpr uintptr_t READY   = 3;
+        static constexpr uintptr_t kTagMask = 3;
+
+        static constexpr uintptr_t tag(uintptr_t word) noexcept { return word & kTagMask; }
+        static Node* nodes(uintptr_t word) noexcept { return reinterpret_cast<Node*>(word & ~kTagMask); }
+
+        std::atomic<uintptr_t> word_{EMPTY};    ///< Tagged state word.
+        std::atomic<uint32_t> refs_{1};         ///< Number of StateRefs owning the state.
+        std::atomic<uint32_t> waiters_{0};      ///< Threads blocked in wait().
+        core::Task slot_;                       ///< Inline continuation (valid in state ONE).
+
+        template <typename S>
+        friend class StateRef;
+
+        static void free_node(Node* node) noexcept {
+            node->~Node();
+            core::SlabAllocator::deallocate_bytes(node, sizeof(Node), alignof(Node));
+        }
+
+    public:
+        ContinuationState() noexcept = default;
+        ContinuationState(const ContinuationState&) = delete;
+        ContinuationState& operator=(const ContinuationState&) = delete;
+
+        /**
+         * @brief Destroys continuations of a state that never became ready.
+         */
+        ~ContinuationState() {
+            const uintptr_t word = word_.load(std::memory_order_acquire);
+            if (tag(word) == READY)
+                return;
+            if (tag(word) == ONE)
+                slot_.destroy();
+            for (Node* node = nodes(word); node;) {
+                Node* next = node->next;
+                node->task.destroy();
+                free_node(node);
+                node = next;
+            }
+        }
+
+        /**
+         * @brief Returns true once the value or exception has been published.
+         */
+        [[nodiscard]] bool is_ready() const noexcept {
+            return tag(word_.load(std::memory_order_acquire)) == READY;
+        }
+
+        /**
+         * @brief Blocks the calling thread until the state is ready, sleeping on the state word.
+         */
+        void wait() noexcept {
+            if (is_ready())
+                return;
+            // Announce ourselves before re-reading the word (pairs with mark_ready()).
+            waiters_.fetch_add(1, std::memory_order_seq_cst);
+            for (uintptr_t word = word_.load(std::memory_order_seq_cst);
+                 tag(word) != READY;
+                 word = word_.load(std::memory_order_seq_cst)) {
+                word_.wait(word, std::memory_order_acquire);
+            }
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Registers a continuation to run once the state becomes ready.
+         *
+         * @param cont Continuation to register.
+         * @return False if the state is already ready: the caller keeps ownership of
+         *         `cont` and must schedule it itself.
+         */
+        bool try_register(core::Task& cont) noexcept {
+            assert(cont && "Registering an empty continuation");
+            uintptr_t word = word_.load(std::memory_order_acquire);
+            Node* node = nullptr;
+
+            for (;;) {
+                if (tag(word) == READY) {
+                    if (node)
+                        free_node(node);
+                    return false;
+                }
+
+                if (word == EMPTY) {
+                    if (!word_.compare_exchange_weak(word, CLAIMED,
+                                                     std::memory_order_acquire,
+                                                     std::memory_order_acquire))
+                        continue;
+
+                    // The inline slot is ours: fill it, then publish it, keeping any
+                    // nodes pushed meanwhile. A fulfiller that saw CLAIMED left it to us.
+                    slot_ = cont;
+                    word = CLAIMED;
+                    while (!word_.compare_exchange_weak(word, (word & ~kTagMask) | ONE,
+                                                        std::memory_order_release,
+                                                        std::memory_order_acquire)) {
+                        if (tag(word) == READY)
+                            return false;
+                    }
+                    return true;
+                }
+
+                // The slot is taken: push a node.
+                if (!node) {
+                    void* mem = core::SlabAllocator::allocate_bytes(sizeof(Node), alignof(Node));
+                    node = ::new (mem) Node{cont, nullptr};
+                }
+                node->next = nodes(word);
+                if (word_.compare_exchange_weak(word, reinterpret_cast<uintptr_t>(node) | tag(word),
+                                                std::memory_order_release,
+                                                std::memory_order_acquire))
+                    return true;
+            }
+        }
+
+        /**
+         * @brief Publishes readiness and hands every registered continuation to `dispatch`.
+         *
+         * Everything written to the state before this call is visible to whoever observes
+         * it ready. Threads blocked in wait() are woken up.
+         * @param dispatch Callable taking a `core::Task&&`.
+         */
+        template <typename Dispatch>
+        void mark_ready(Dispatch&& dispatch) noexcept {
+            const uintptr_t word = word_.exchange(READY, std::memory_order_seq_cst);
+            assert(tag(word) != READY && "SharedState fulfilled twice");
+
+            if (waiters_.load(std::memory_order_seq_cst) != 0)
+                word_.notify_all();
+
+            // In state CLAIMED the registrant sees READY and schedules its own continuation.
+            if (tag(word) == ONE)
+                dispatch(std::move(slot_));
+
+            for (Node* node = nodes(word); node;) {
+                Node* next = node->next;
+                dispatch(std::move(node->task));
+                free_node(node);
+                node = next;
+            }
+        }
+    };
+
     /**
      * @brief Shared state between a Promise<T> and its corresponding Future<T>.
      *
-     * This structure holds the result value, readiness flag, stored exception,
-     * and continuation tasks registered via Future::then().
+     * This structure holds the result value, stored exception, the cancellation token
+     * of the producing task, and the lock-free readiness/continuation state inherited
+     * from ContinuationState.
      *
      * @tparam T The result type produced by the asynchronous operation.
      */
     template <typename T>
-    struct SharedState {
-        mutable std::mutex mtx;               ///< Protects access to value and continuations.
-        std::atomic<bool> ready{false};       ///< True once value or exception is set.
-
+    struct SharedState : ContinuationState {
         std::optional<T> value;               ///< The result value (if successful).
         std::exception_ptr exception;         ///< Exception captured during task execution.
-        std::vector<core::Task> continuations;      ///< Tasks to run once the state becomes ready.
+        CancellationToken token;              ///< Cancellation inherited by continuations.
     };
 
     /**
@@ -38,12 +214,9 @@ namespace rts::async {
      * This variant omits the value storage since there’s no return value to store.
      */
     template <>
-    struct SharedState<void> {
-        mutable std::mutex mtx;
-        std::atomic<bool> ready{false};
-
+    struct SharedState<void> : ContinuationState {
         std::exception_ptr exception;
-        std::vector<core::Task> continuations;
+        CancellationToken token;
     };
 
 } // namespace rts::async
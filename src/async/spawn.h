@@ -13,6 +13,7 @@
 #include <type_traits>
 
 
+#include "cancellation.h"
 #include "concepts.h"
 #include "future.h"
 #include "promise.h"
@@ -27,16 +28,21 @@ namespace rts::async {
     class Future;
 
     /**
-     * @brief Asynchronously enqueues a callable for execution and returns a Future for its result.
+     * @brief Asynchronously enqueues a cancellable callable and returns a Future for its result.
+     *
+     * The token is inherited by every continuation chained on the returned Future. If
+     * cancellation is requested before a worker dequeues the task, the callable is not
+     * invoked and the Future fails with TaskCancelled.
      *
      * @tparam F Callable type.
      * @tparam Args Argument pack for callable.
+     * @param token Cancellation token of the task.
      * @return async::Future<T> representing the result.
      *
      * @note The callable is executed inside the runtime’s thread pool.
      */
     template<typename F, typename... Args>
-    auto spawn(F&& f, Args&&... args)
+    auto spawn(CancellationToken token, F&& f, Args&&... args)
         -> Future<std::invoke_result_t<F, Args...>> {
 
         using T = std::invoke_result_t<F, Args...>;
@@ -44,26 +50,46 @@ namespace rts::async {
         assert(core::running.load(std::memory_order_acquire) && "enqueue_async() called on inactive runtime");
         assert(core::enqueue_fn && "enqueue_async() called before initialization");
 
-        Promise<T> p;
+        Promise<T> p(std::move(token));
         auto fut = p.get_future();
 
         // Capture the promise by value (moved)
         core::Task task = [func = std::forward<F>(f),
                      args_tuple = std::make_tuple(std::forward<Args>(args)...),
                      p = std::move(p)]() mutable {
+            if (p.cancel_if_requested())
+                return;
             try {
                 if constexpr (std::is_void_v<T>) {
                     std::apply(func, std::move(args_tuple));
+                    core::record_spawn_to_ready();
                     p.set_value();
                 } else {
                     T result = std::apply(func, std::move(args_tuple));
+                    core::record_spawn_to_ready();
                     p.set_value(std::move(result));
                 }
             } catch (...) {
+                core::record_spawn_to_ready();
                 p.set_exception(std::current_exception());
             }
         };
         enqueue(std::move(task));
         return fut;
     }
+
+    /**
+     * @brief Asynchronously enqueues a callable for execution and returns a Future for its result.
+     *
+     * @tparam F Callable type.
+     * @tparam Args Argument pack for callable.
+     * @return async::Future<T> representing the result.
+     *
+     * @note The callable is executed inside the runtime’s thread pool.
+     */
+    template<typename F, typename... Args>
+    auto spawn(F&& f, Args&&... args)
+        -> Future<std::invoke_result_t<F, Args...>> {
+        return spawn(CancellationToken{}, std::forward<F>(f), std::forward<Args>(args)...);
+    }
 } // namespace rts::async
\ No newline at end of file
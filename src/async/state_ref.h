@@ -0,0 +1,84 @@
+/**
+ * @file state_ref.h
+ * @brief Defines StateRef, the intrusive reference-counted handle to async states.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "slab_allocator.h"
+
+namespace rts::async {
+
+    /**
+     * @brief Intrusive owning handle to a reference-counted state (SharedState, CancellationState,
+     *        WhenAnyChoice).
+     *
+     * The reference count (a `refs_` member, starting at one) lives in the state itself,
+     * which is allocated in a single slab block together with the rest of its data.
+     * Copying a StateRef costs one atomic increment; moving it costs nothing, so
+     * ownership transfers should move.
+     *
+     * @tparam S The concrete shared state type (e.g. SharedState<T>).
+     */
+    template <typename S>
+    class StateRef {
+        S* ptr_ = nullptr;
+
+        explicit StateRef(S* ptr) noexcept : ptr_(ptr) {}
+
+    public:
+        StateRef() noexcept = default;
+
+        /**
+         * @brief Allocates a fresh state, constructed from `args` with a count of one,
+         *        from the calling thread's slab.
+         */
+        template <typename... Args>
+        [[nodiscard]] static StateRef make(Args&&... args) {
+            void* mem = core::SlabAllocator::allocate_bytes(sizeof(S), alignof(S));
+            return StateRef(::new (mem) S(std::forward<Args>(args)...));
+        }
+
+        StateRef(const StateRef& other) noexcept : ptr_(other.ptr_) {
+            if (ptr_)
+                ptr_->refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        StateRef(StateRef&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+
+        StateRef& operator=(const StateRef& other) noexcept {
+            StateRef(other).swap(*this);
+            return *this;
+        }
+
+        StateRef& operator=(StateRef&& other) noexcept {
+            StateRef(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        ~StateRef() { reset(); }
+
+        /**
+         * @brief Drops this reference, destroying the state if it was the last one.
+         */
+        void reset() noexcept {
+            S* ptr = std::exchange(ptr_, nullptr);
+            if (ptr && ptr->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ptr->~S();
+                core::SlabAllocator::deallocate_bytes(ptr, sizeof(S), alignof(S));
+            }
+        }
+
+        void swap(StateRef& other) noexcept { std::swap(ptr_, other.ptr_); }
+
+        S* get() const noexcept { return ptr_; }
+        S* operator->() const noexcept { return ptr_; }
+        S& operator*() const noexcept { return *ptr_; }
+        explicit operator bool() const noexcept { return ptr_ != nullptr; }
+    };
+
+} // namespace rts::async
@@ -8,10 +8,19 @@
 #include <tuple>
 #include <utility>
 #include <atomic>
+#include <concepts>
 #include <exception>
+#include <new>
+#include <optional>
+#include <ranges>
 #include <variant>
+#include <vector>
+#include "cancellation.h"
+#include "combining_tree.h"
+#include "constants.h"
 #include "future.h"
 #include "promise.h"
+#include "slab_allocator.h"
 
 
 namespace rts::async {
@@ -19,7 +28,101 @@ namespace rts::async {
 template <typename F>
 using future_value_t = typename std::decay_t<F>::value_type;
 
+/**
+ * @brief True for the Future types accepted by the combinators.
+ */
+template <typename F>
+inline constexpr bool is_future_v = false;
+
+template <typename T>
+inline constexpr bool is_future_v<Future<T>> = true;
+
+/**
+ * @brief A runtime-sized (forward) range of Futures, e.g. `std::vector<Future<T>>`.
+ */
+template <typename R>
+concept FutureRange =
+    std::ranges::forward_range<R> &&
+    is_future_v<std::remove_cvref_t<std::ranges::range_value_t<R>>>;
+
+/**
+ * @brief Returns the cancellation token shared by all `futures`, or an empty token if they differ.
+ *
+ * Combinators give it to the Future they return, so its continuations are cancelled
+ * together with the inputs.
+ */
+template <typename First, typename... Rest>
+CancellationToken common_token(const First& first, const Rest&... rest) noexcept {
+    return ((rest.token() == first.token()) && ...) ? first.token() : CancellationToken{};
+}
+
+/**
+ * @brief Range version of common_token(); empty ranges have no token.
+ */
+template <FutureRange R>
+CancellationToken common_token(const R& futures) noexcept {
+    auto it = std::ranges::begin(futures);
+    if (it == std::ranges::end(futures))
+        return {};
+    const CancellationToken& first = (*it).token();
+    for (; it != std::ranges::end(futures); ++it) {
+        if (!((*it).token() == first))
+            return {};
+    }
+    return first;
+}
+
+/**
+ * @brief Bookkeeping shared by the continuations of a when_all().
+ *
+ * Every input writes its own slot, then arrives on a CombiningTree (a single counter
+ * unless there are more than `fan_in` inputs). The first input to fail (or be cancelled)
+ * fails the combined Promise right away; otherwise the last input to arrive publishes
+ * the result. The last input also frees the join: it is allocated
+ * from the slab with create() and never touched by an input after it arrived.
+ *
+ * @tparam T     Value type of the combined Future.
+ * @tparam Slots Storage for the input values (unused for Future<void> results).
+ */
+template <typename T, typename Slots = std::monostate>
+struct WhenAllJoin {
+    Promise<T> promise;
+    Slots slots {};
+    core::CombiningTree remaining;
+    std::atomic<bool> failed {false};
+
+    WhenAllJoin(Promise<T> p, std::size_t n, std::size_t fan_in)
+        : promise(std::move(p)), remaining(n, fan_in) {}
+
+    /// @brief Allocates a join waiting for the inputs `[0, n)`.
+    static WhenAllJoin* create(Promise<T> p, std::size_t n, std::size_t fan_in = core::kFanInPerCounter) {
+        void* mem = core::SlabAllocator::allocate_bytes(sizeof(WhenAllJoin), alignof(WhenAllJoin));
+        return ::new (mem) WhenAllJoin(std::move(p), n, fan_in);
+    }
+
+    /// @brief Fails the combined Promise, unless another input already did.
+    void fail(std::exception_ptr e) noexcept {
+        if (!failed.exchange(true, std::memory_order_acq_rel))
+            promise.set_exception(std::move(e));
+    }
+
+    /**
+     * @brief Records the arrival of input `index`. The last one calls `publish(*this)`,
+     *        unless an input failed, and frees the join.
+     */
+    template <typename Publish>
+    void arrive(std::size_t index, Publish&& publish) noexcept {
+        if (!remaining.arrive(index))
+            return;
+        if (!failed.load(std::memory_order_relaxed))
+            publish(*this);
+        this->~WhenAllJoin();
+        core::SlabAllocator::deallocate_bytes(this, sizeof(WhenAllJoin), alignof(WhenAllJoin));
+    }
+};
+
 template <typename... Futures>
+requires (is_future_v<std::remove_cvref_t<Futures>> && ...)
 auto when_all(Futures&&... futures) {
     constexpr std::size_t N = sizeof...(Futures);
     static_assert(N > 0, "when_all() requires at least one Future");
@@ -28,18 +131,20 @@ auto when_all(Futures&&... futures) {
 
     if constexpr (all_void) {
         // ── All inputs are Future<void> → return Future<void>
-        Promise<void> prom;
-        auto out = prom.get_future();
-
-        auto remaining = std::make_shared<std::atomic<std::size_t>>(N);
-        auto fulfill = [prom = std::move(prom), remaining]() mutable {
-            if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
-                prom.set_value();
-            }
-        };
+        using join_t = WhenAllJoin<void>;
+        auto* join = join_t::create(Promise<void>(common_token(futures...)), N);
+        auto out = join->promise.get_future();
 
-        auto attach_one = [fulfill](auto& fut) {
-            fut.then([fulfill]() mutable { fulfill(); });
+        std::size_t index = 0;
+        auto attach_one = [join, &index](auto& fut) {
+            fut.on_ready([join, i = index++](auto& ready) noexcept {
+                try {
+                    ready.get();
+                } catch (...) {
+                    join->fail(std::current_exception());
+                }
+                join->arrive(i, [](join_t& j) { j.promise.set_value(); });
+            });
         };
         (attach_one(futures), ...);
 
@@ -58,37 +163,33 @@ auto when_all(Futures&&... futures) {
                                std::optional<future_value_t<Futures>>>...
         >;
 
-        Promise<result_tuple_t> prom;
-        auto out = prom.get_future();
-
-        auto state     = std::make_shared<state_tuple_t>();
-        auto remaining = std::make_shared<std::atomic<std::size_t>>(N);
-
-        auto fulfill = [prom = std::move(prom), state, remaining]() mutable {
-            if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
-                auto result = std::apply(
-                    []<typename... Ts>(std::optional<Ts>&... opts) -> result_tuple_t {
-                        return result_tuple_t{ (opts ? std::move(*opts) : Ts{})... };
-                    },
-                    *state
-                );
-                prom.set_value(std::move(result));
-            }
-        };
+        using join_t = WhenAllJoin<result_tuple_t, state_tuple_t>;
+        auto* join = join_t::create(Promise<result_tuple_t>(common_token(futures...)), N);
+        auto out = join->promise.get_future();
 
-        auto attach_one = [state, fulfill]<std::size_t I>(auto& fut, std::integral_constant<std::size_t, I>) {
-            using V = future_value_t<decltype(fut)>;
-            if constexpr (std::is_void_v<V>) {
-                fut.then([state, fulfill]() mutable {
-                    std::get<I>(*state).emplace(std::monostate{});
-                    fulfill();
-                });
-            } else {
-                fut.then([state, fulfill](auto&& v) mutable {
-                    std::get<I>(*state).emplace(std::forward<decltype(v)>(v));
-                    fulfill();
+        auto attach_one = [join]<std::size_t I>(auto& fut, std::integral_constant<std::size_t, I>) {
+            fut.on_ready([join](auto& ready) noexcept {
+                try {
+                    if constexpr (std::is_void_v<future_value_t<decltype(ready)>>) {
+                        ready.get();
+                        std::get<I>(join->slots).emplace(std::monostate{});
+                    } else {
+                        std::get<I>(join->slots).emplace(ready.get());
+                    }
+                } catch (...) {
+                    join->fail(std::current_exception());
+                }
+                join->arrive(I, [](join_t& j) {
+                    // Only published when every input succeeded: all slots are engaged.
+                    auto result = std::apply(
+                        [](auto&... opts) -> result_tuple_t {
+                            return result_tuple_t{ std::move(*opts)... };
+                        },
+                        j.slots
+                    );
+                    j.promise.set_value(std::move(result));
                 });
-            }
+            });
         };
 
         [&]<std::size_t... Is>(std::index_sequence<Is...>) {
@@ -98,4 +199,82 @@ auto when_all(Futures&&... futures) {
         return out; // return here (different type), but only this branch is active
     }
 }
+
+/**
+ * @brief Combines a runtime-sized range of Futures into one Future.
+ *
+ * Resolves with the values in input order (`Future<std::vector<T>>`), or with nothing
+ * (`Future<void>`) for a range of Future<void>. The result vector is allocated once up
+ * front; each input writes its own slot without locking and arrives on a shared counter.
+ * An empty range yields a ready Future.
+ *
+ * Ranges wider than `fan_in` count completions with a core::CombiningTree, so no counter
+ * sees more than `fan_in` arrivals however wide the fan-in; pass `SIZE_MAX` to force a
+ * single flat counter.
+ */
+template <FutureRange R>
+auto when_all(R&& futures, std::size_t fan_in = core::kFanInPerCounter) {
+    using T = future_value_t<std::ranges::range_value_t<R>>;
+    const auto n = static_cast<std::size_t>(std::ranges::distance(futures));
+
+    if constexpr (std::is_void_v<T>) {
+        using join_t = WhenAllJoin<void>;
+        auto* join = join_t::create(Promise<void>(common_token(futures)), n + 1, fan_in);
+        auto out = join->promise.get_future();
+        auto publish = [](join_t& j) { j.promise.set_value(); };
+
+        std::size_t index = 0;
+        for (auto&& fut : futures) {
+            fut.on_ready([join, index, publish](auto& ready) noexcept {
+                try {
+                    ready.get();
+                } catch (...) {
+                    join->fail(std::current_exception());
+                }
+                join->arrive(index, publish);
+            });
+            ++index;
+        }
+        // The extra arrival keeps the join alive while attaching (and completes empty ranges).
+        join->arrive(n, publish);
+        return out;
+    } else {
+        // Default-constructible values are written straight into the result vector, except
+        // bool: std::vector<bool> packs its elements, so concurrent writes would race.
+        constexpr bool direct = std::default_initializable<T> && !std::same_as<T, bool>;
+        using slots_t = std::conditional_t<direct, std::vector<T>, std::vector<std::optional<T>>>;
+        using join_t = WhenAllJoin<std::vector<T>, slots_t>;
+
+        auto* join = join_t::create(Promise<std::vector<T>>(common_token(futures)), n + 1, fan_in);
+        join->slots.resize(n);
+        auto out = join->promise.get_future();
+
+        auto publish = [](join_t& j) {
+            if constexpr (direct) {
+                j.promise.set_value(std::move(j.slots));
+            } else {
+                std::vector<T> result;
+                result.reserve(j.slots.size());
+                for (auto& slot : j.slots)
+                    result.push_back(std::move(*slot));
+                j.promise.set_value(std::move(result));
+            }
+        };
+
+        std::size_t index = 0;
+        for (auto&& fut : futures) {
+            fut.on_ready([join, index, publish](auto& ready) noexcept {
+                try {
+                    join->slots[index] = ready.get();
+                } catch (...) {
+                    join->fail(std::current_exception());
+                }
+                join->arrive(index, publish);
+            });
+            ++index;
+        }
+        join->arrive(n, publish);
+        return out;
+    }
+}
 } // namespace rts::async
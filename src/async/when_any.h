@@ -1,94 +1,216 @@
-
+/**
+ * @file when_any.h
+ * @brief Combines multiple Futures into one Future that resolves with the first ready input.
+ */
 
 #pragma once
 
+#include <array>
 #include <tuple>
 #include <utility>
 #include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <exception>
+#include <stdexcept>
 #include <variant>
+#include <vector>
+#include "cancellation.h"
 #include "future.h"
 #include "promise.h"
+#include "slab_allocator.h"
+#include "state_ref.h"
+#include "when_all.h"
 
 namespace rts::async {
 
+/**
+ * @brief Tag asking when_any() to cancel the inputs that did not win.
+ */
+struct CancelLosers {
+    explicit CancelLosers() = default;
+};
+
+inline constexpr CancelLosers cancel_losers {};
+
+/**
+ * @brief Bookkeeping shared by the continuations of a when_any().
+ *
+ * Owned through StateRef by the continuation attached to every input, so it lives until
+ * the last of them has run (or been dropped by cancellation).
+ *
+ * @tparam T      Value type of the combined Future.
+ * @tparam Tokens Container of the inputs' tokens (`std::array` or `std::vector`).
+ */
+template <typename T, typename Tokens>
+struct WhenAnyChoice {
+    Promise<T> promise;
+    Tokens tokens;                              ///< Token of every input (only read when cancelling).
+    bool cancel_losers;                         ///< Cancel the other inputs once one wins.
+    std::atomic<bool> won {false};
+    std::atomic<uint32_t> refs_ {1};            ///< Number of StateRefs owning the choice.
+
+    WhenAnyChoice(Promise<T> p, Tokens input_tokens, bool cancel) noexcept
+        : promise(std::move(p)), tokens(std::move(input_tokens)), cancel_losers(cancel) {}
+
+    /**
+     * @brief Returns true for the first input to become ready, cancelling the others if requested.
+     *
+     * Tokens shared with the winner are left alone, so the winner's own continuations still run.
+     */
+    bool try_win(std::size_t index) noexcept {
+        if (won.load(std::memory_order_relaxed) || won.exchange(true, std::memory_order_acq_rel))
+            return false;
+        if (cancel_losers) {
+            for (std::size_t i = 0; i < tokens.size(); ++i) {
+                if (i != index && tokens[i] != tokens[index])
+                    CancellationSource::from(tokens[i]).request_cancellation();
+            }
+        }
+        return true;
+    }
+};
 
-template <typename F>
-using future_value_t = typename std::decay_t<F>::value_type;
+/**
+ * @brief Implementation of when_any(), with or without cancelling the losers.
+ */
+template <typename... Futures>
+auto when_any_impl(bool cancel, Futures... futures) {
+    constexpr std::size_t N = sizeof...(Futures);
+    static_assert(N > 0, "when_any() requires at least one Future");
 
+    constexpr bool all_void = (std::is_void_v<future_value_t<Futures>> && ...);
 
+    // All inputs are Future<void> → Future<void>; otherwise Future<std::variant<...>>
+    // with the first ready input stored in the matching alternative (void → monostate).
+    using variant_t = std::variant<
+        std::conditional_t<std::is_void_v<future_value_t<Futures>>,
+                           std::monostate,
+                           future_value_t<Futures>>...
+    >;
+    using result_t = std::conditional_t<all_void, void, variant_t>;
+
+    using choice_t = WhenAnyChoice<result_t, std::array<CancellationToken, N>>;
+    auto choice = StateRef<choice_t>::make(Promise<result_t>(common_token(futures...)),
+                                           std::array<CancellationToken, N>{futures.token()...},
+                                           cancel);
+    auto out = choice->promise.get_future();
+
+    auto attach_one = [&choice]<std::size_t I>(auto& fut, std::integral_constant<std::size_t, I>) {
+        fut.on_ready([choice](auto& ready) noexcept {
+            if (!choice->try_win(I))
+                return;
+            // The first input to be ready wins, whether it holds a value or an exception.
+            try {
+                if constexpr (all_void) {
+                    ready.get();
+                    choice->promise.set_value();
+                } else if constexpr (std::is_void_v<future_value_t<decltype(ready)>>) {
+                    ready.get();
+                    choice->promise.set_value(variant_t{std::in_place_index<I>});
+                } else {
+                    choice->promise.set_value(variant_t{std::in_place_index<I>, ready.get()});
+                }
+            } catch (...) {
+                choice->promise.set_exception(std::current_exception());
+            }
+        });
+    };
+
+    // Expand the futures over their indices
+    [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        (attach_one(futures, std::integral_constant<std::size_t, Is>{}), ...);
+    }(std::index_sequence_for<Futures...>{});
 
+    return out;
+}
 
+/**
+ * @brief Returns a Future that resolves with the first of `futures` to be ready.
+ */
 template <typename... Futures>
+requires (is_future_v<Futures> && ...)
 auto when_any(Futures... futures) {
-    constexpr std::size_t N = sizeof...(Futures);
-    static_assert(N > 0, "when_any() requires at least one Future");
+    return when_any_impl(false, std::move(futures)...);
+}
 
-    constexpr bool all_void = (std::is_void_v<future_value_t<Futures>> && ...);
+/**
+ * @brief Like when_any(), but requests cancellation of the losers' tokens once an input wins,
+ *        so their queued tasks and continuations are dropped.
+ *
+ * @note Any other work sharing a loser's token is cancelled as well.
+ */
+template <typename... Futures>
+requires (is_future_v<Futures> && ...)
+auto when_any(CancelLosers, Futures... futures) {
+    return when_any_impl(true, std::move(futures)...);
+}
 
-    if constexpr (all_void) {
-        // ── All inputs are Future<void> → return Future<void>
-        Promise<void> prom;
-        auto out = prom.get_future();
-
-        auto remaining = std::make_shared<std::atomic<std::size_t>>(1);
-        auto fulfill = [prom = std::move(prom), remaining]() mutable {
-            if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
-                prom.set_value();
-        };
-
-        auto attach_one = [fulfill](auto& fut) {
-            fut.then([fulfill]() mutable { fulfill(); });
-        };
-        (attach_one(futures), ...);
-
-        return out; // return here, no trailing return afterward
-    } else {
-        // ── Mixed / non-void case → Future<std::variant<...>>
-        using variant_t = std::variant<
-            std::conditional_t<std::is_void_v<future_value_t<Futures>>,
-                               std::monostate,
-                               future_value_t<Futures>>...
-        >;
-
-        Promise<variant_t> prom;
-        auto out = prom.get_future();
-
-        // A flag to ensure only the first result is taken
-        auto won = std::make_shared<std::atomic<bool>>(false);
-
-        auto fulfill = [prom = std::move(prom), won](auto&& result) mutable {
-            bool expected = false;
-            if (won->compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
-                prom.set_value(std::forward<decltype(result)>(result));
-            }
-        };
-
-        auto attach_one = [fulfill, won]<std::size_t I>(auto& fut, std::integral_constant<std::size_t, I>) {
-            using V = future_value_t<decltype(fut)>;
-
-            if constexpr (std::is_void_v<V>) {
-                fut.then([fulfill, won]() mutable {
-                    if (!won->load(std::memory_order_acquire)) {
-                        fulfill(std::variant_alternative_t<I, variant_t>{std::monostate{}});
-                    }
-                });
-            } else {
-                fut.then([fulfill, won](auto&& v) mutable {
-                    if (!won->load(std::memory_order_acquire)) {
-                        fulfill(std::variant_alternative_t<I, variant_t>{std::forward<decltype(v)>(v)});
-                    }
-                });
-            }
-        };
+/**
+ * @brief Implementation of the range overloads of when_any().
+ */
+template <FutureRange R>
+auto when_any_range_impl(bool cancel, R&& futures) {
+    using T = future_value_t<std::ranges::range_value_t<R>>;
+    using result_t = std::conditional_t<std::is_void_v<T>, std::size_t, std::pair<std::size_t, T>>;
+    if (std::ranges::begin(futures) == std::ranges::end(futures)) {
+        // No input can ever win: fail instead of returning a Future that never becomes ready.
+        Promise<result_t> empty;
+        empty.set_exception(std::make_exception_ptr(std::invalid_argument("when_any() of an empty range")));
+        return empty.get_future();
+    }
 
-        // Expand the futures over their indices
-        [&]<std::size_t... Is>(std::index_sequence<Is...>) {
-            (attach_one(futures, std::integral_constant<std::size_t, Is>{}), ...);
-        }(std::index_sequence_for<Futures...>{});
+    // Tokens are only needed to cancel the losers.
+    std::vector<CancellationToken> tokens;
+    if (cancel) {
+        for (auto&& fut : futures)
+            tokens.push_back(fut.token());
+    }
 
-        return out;
+    using choice_t = WhenAnyChoice<result_t, std::vector<CancellationToken>>;
+    auto choice = StateRef<choice_t>::make(Promise<result_t>(common_token(futures)),
+                                           std::move(tokens),
+                                           cancel);
+    auto out = choice->promise.get_future();
+
+    std::size_t index = 0;
+    for (auto&& fut : futures) {
+        fut.on_ready([choice, index](auto& ready) noexcept {
+            if (!choice->try_win(index))
+                return;
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    ready.get();
+                    choice->promise.set_value(std::size_t{index});
+                } else {
+                    choice->promise.set_value(result_t{index, ready.get()});
+                }
+            } catch (...) {
+                choice->promise.set_exception(std::current_exception());
+            }
+        });
+        ++index;
     }
+    return out;
+}
+
+/**
+ * @brief Returns a Future that resolves with the index and value of the first ready Future
+ *        of a range (`Future<std::pair<size_t, T>>`, or `Future<size_t>` for void).
+ *
+ * An empty range yields a Future holding `std::invalid_argument`.
+ */
+template <FutureRange R>
+auto when_any(R&& futures) {
+    return when_any_range_impl(false, std::forward<R>(futures));
+}
+
+/**
+ * @brief Range version of when_any(cancel_losers, ...).
+ */
+template <FutureRange R>
+auto when_any(CancelLosers, R&& futures) {
+    return when_any_range_impl(true, std::forward<R>(futures));
 }
 
-}
\ No newline at end of file
+} // namespace rts::async
@@ -0,0 +1,110 @@
+/**
+ * @file combining_tree.h
+ * @brief Defines a completion counter for wide fan-ins.
+ *
+ * A single atomic counter decremented by thousands of inputs completing on many
+ * workers turns into one contended cache line. The CombiningTree splits the count
+ * over a tree of counters, each on its own cache line: an input only touches its
+ * leaf, and only the last arrival at a node moves on to the parent, so no counter
+ * ever sees more than `fan_in` arrivals.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+#include "constants.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Counts down `size` arrivals and reports the last one.
+     *
+     * Inputs are grouped by index: inputs `[j * fan_in, (j + 1) * fan_in)` share leaf `j`,
+     * leaves are grouped the same way one level up, and so on until at most `fan_in`
+     * nodes remain below the (unpadded) root counter. With `size <= fan_in` the tree is
+     * just the root, i.e. a flat counter, and nothing is allocated.
+     *
+     * Arrivals are acquire-release all the way up: the thread that observes the last
+     * arrival sees everything the other arriving threads wrote before arriving.
+     */
+    class CombiningTree {
+        /// @brief Inner counter, padded to avoid false sharing between siblings.
+        struct alignas(kCacheLine) Node {
+            std::atomic<size_t> pending {0};
+        };
+
+        std::atomic<size_t> root_;          ///< Arrivals (or completed top-level nodes) left.
+        std::unique_ptr<Node[]> nodes_;     ///< Levels below the root, leaves first.
+        size_t size_;                       ///< Number of arrivals expected.
+        size_t fan_in_;                     ///< Maximum arrivals per counter.
+        size_t levels_ = 0;                 ///< Number of levels below the root.
+
+    public:
+        /**
+         * @param size   Number of arrivals (one per index in `[0, size)`).
+         * @param fan_in Maximum arrivals per counter; pass `SIZE_MAX` for a single flat counter.
+         */
+        explicit CombiningTree(size_t size, size_t fan_in = kFanInPerCounter)
+            : size_(size), fan_in_(fan_in) {
+            assert(fan_in >= 2 && "A combining tree needs a fan-in of at least 2");
+
+            size_t width = size;
+            size_t total = 0;
+            for (; width > fan_in_; ++levels_) {
+                width = (width + fan_in_ - 1) / fan_in_;
+                total += width;
+            }
+            root_.store(width, std::memory_order_relaxed);
+            if (levels_ == 0)
+                return;
+
+            nodes_ = std::make_unique<Node[]>(total);
+            size_t below = size;
+            Node* level = nodes_.get();
+            for (size_t l = 0; l < levels_; ++l) {
+                const size_t count = (below + fan_in_ - 1) / fan_in_;
+                for (size_t j = 0; j < count; ++j) {
+                    const size_t first = j * fan_in_;
+                    level[j].pending.store(std::min(fan_in_, below - first), std::memory_order_relaxed);
+                }
+                level += count;
+                below = count;
+            }
+        }
+
+        CombiningTree(const CombiningTree&) = delete;
+        CombiningTree& operator=(const CombiningTree&) = delete;
+
+        /**
+         * @brief Records the arrival of input `index`; each index must arrive exactly once.
+         *
+         * @return True for the last arrival overall.
+         */
+        bool arrive(size_t index) noexcept {
+            assert(index < size_ && "Arrival index out of range");
+            size_t width = size_;
+            Node* level = nodes_.get();
+            for (size_t l = 0; l < levels_; ++l) {
+                index /= fan_in_;
+                width = (width + fan_in_ - 1) / fan_in_;
+                if (level[index].pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    return false;
+                level += width;
+            }
+            return root_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
+        /**
+         * @brief Returns the number of levels below the root (0 for a flat counter).
+         */
+        [[nodiscard]] size_t depth() const noexcept {
+            return levels_;
+        }
+    };
+
+} // namespace rts::core
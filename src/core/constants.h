@@ -48,11 +48,87 @@ namespace rts::core {
      */
     inline constexpr size_t kDefaultCapacity = 1024;
 
+    /**
+     * @brief Whether Tasks carry their submission tick, so that workers record the
+     *        latency histograms returned by rts::latency_stats().
+     *
+     * Set with the `MINIRTS_LATENCY_STATS` macro (CMake option of the same name, off by default).
+     */
+#ifndef MINIRTS_LATENCY_STATS
+#define MINIRTS_LATENCY_STATS 0
+#endif
+    inline constexpr bool kLatencyStats = MINIRTS_LATENCY_STATS != 0;
+
+    /**
+     * @brief Size of the inline buffer of a Task.
+     *
+     * Callables up to this size are stored inside the Task instead of on the heap.
+     * Together with its two function pointers (and its submission tick with kLatencyStats),
+     * a Task then fills one 64-byte cache line.
+     */
+    inline constexpr size_t kTaskInlineSize = kLatencyStats ? 40 : 48;
+
+    /**
+     * @brief Size of the chunks carved by the per-thread slab allocator (must be a power of two).
+     */
+    inline constexpr size_t kSlabChunkSize = 64 * 1024;
+
+    /**
+     * @brief Largest block served by the slab allocator in 16-byte size classes.
+     */
+    inline constexpr size_t kMaxSmallSlabBlockSize = 256;
+
+    /**
+     * @brief Largest block served by the slab allocator; bigger requests use operator new.
+     *
+     * Above kMaxSmallSlabBlockSize, the size classes grow by half powers of two
+     * (384, 512, 768, ...), so that typical coroutine frames come from slabs too.
+     */
+    inline constexpr size_t kMaxSlabBlockSize = 2048;
+
     /**
      * @brief Global debug flag for conditional instrumentation and assertions.
      */
     constexpr bool DEBUG = false;
 
+    /**
+     * @brief Whether workers count their scheduler events, as reported by rts::stats().
+     *
+     * Set with the `MINIRTS_WORKER_STATS` macro (CMake option of the same name). When
+     * false, no counting code is compiled and the counters stay at zero.
+     */
+#ifndef MINIRTS_WORKER_STATS
+#define MINIRTS_WORKER_STATS 1
+#endif
+    inline constexpr bool kWorkerStats = MINIRTS_WORKER_STATS != 0;
+
+    /**
+     * @brief Whether workers record a timeline of their tasks, steals, inbox transfers
+     *        and parks, which rts::write_trace() dumps as a Chrome trace.
+     *
+     * Set with the `MINIRTS_TRACING` macro (CMake option of the same name, off by default).
+     */
+#ifndef MINIRTS_TRACING
+#define MINIRTS_TRACING 0
+#endif
+    inline constexpr bool kTracing = MINIRTS_TRACING != 0;
+
+    /**
+     * @brief Events kept per worker when tracing (a power of two); older ones are overwritten.
+     */
+    inline constexpr size_t kTraceBufferEvents = size_t{1} << 16;
+
+    /**
+     * @brief Whether workers time the phases of their scheduling loop (pop, steal, inbox
+     *        transfer, task execution, idle), as reported by rts::profile().
+     *
+     * Set with the `MINIRTS_PROFILE` macro (CMake option of the same name, off by default).
+     */
+#ifndef MINIRTS_PROFILE
+#define MINIRTS_PROFILE 0
+#endif
+    inline constexpr bool kProfile = MINIRTS_PROFILE != 0;
+
     /**
      * @brief Defines shutdown modes for the runtime system.
      *
@@ -63,4 +139,83 @@ namespace rts::core {
         HARD_SHUTDOWN = 1,
         SOFT_SHUTDOWN = 2
     };
+
+    /**
+     * @brief Defines what a worker does when it runs out of work.
+     *
+     * - `SPIN_IDLE`: Keep polling the queues forever (lowest wake-up latency, burns a full core).
+     * - `PARK_IDLE`: Spin for an adaptive window, then sleep until new work is submitted.
+     */
+    enum IdleMode {
+        SPIN_IDLE = 1,
+        PARK_IDLE = 2
+    };
+
+    /**
+     * @brief Idle mode used when none is specified at initialization.
+     */
+    inline constexpr IdleMode kDefaultIdleMode = PARK_IDLE;
+
+    /**
+     * @brief Bounds and starting point of the adaptive spin window, in idle iterations.
+     *
+     * A worker in `PARK_IDLE` mode polls for up to its current spin limit before parking.
+     * The limit grows when work tends to arrive shortly after going idle and shrinks
+     * every time the worker ends up parking.
+     */
+    inline constexpr size_t kMinIdleSpins = 64;
+    inline constexpr size_t kMaxIdleSpins = 1 << 14;
+    inline constexpr size_t kInitialIdleSpins = 1 << 10;
+
+    /**
+     * @brief Failed steal attempts per victim before a thief escalates to the next StealTier.
+     *
+     * A thief stays on a tier for this many attempts times the tier's size, so each
+     * victim of the tier is probed about this many times before looking farther away.
+     */
+    inline constexpr size_t kStealAttemptsPerVictim = 2;
+
+    /**
+     * @brief Maximum nesting of continuations run inline by a fulfilling worker.
+     *
+     * When a worker fulfills a Promise, it runs the first continuation directly instead of
+     * queueing it, unless it is already this many continuations deep; the others (and every
+     * continuation past this depth) go to its local WSQ. Set to 0 to always queue.
+     */
+    inline constexpr size_t kMaxInlineContinuationDepth = 64;
+
+    /**
+     * @brief Maximum number of arrivals on one counter of a CombiningTree.
+     *
+     * `when_all()` over a range wider than this counts completions with a tree of
+     * counters instead of a single atomic, so contention stays bounded as width grows.
+     */
+    inline constexpr size_t kFanInPerCounter = 64;
+
+    /**
+     * @brief Number of chunks a parallel loop is cut into when no grain size is given.
+     *
+     * Chunks are the unit between two split checks, so this only bounds the overhead of
+     * very cheap bodies; ranges are still split lazily, only when a worker runs dry.
+     */
+    inline constexpr size_t kMaxParallelForChunks = 4096;
+
+    /**
+     * @brief Sequential cutoffs of parallel_sort() and parallel_merge(), in elements.
+     *
+     * Below these sizes the work is done with std::stable_sort / std::merge on the
+     * current worker instead of being split further.
+     */
+    inline constexpr size_t kParallelSortCutoff  = 4096;
+    inline constexpr size_t kParallelMergeCutoff = 8192;
+
+    /**
+     * @brief Block layout of the two-pass scans (prefix sums, copy_if, partition).
+     *
+     * Blocks hold at least kMinScanBlock elements, and there are at most
+     * kScanBlocksPerWorker of them per worker so stealing can even out the passes.
+     * Ranges of a single block are scanned sequentially.
+     */
+    inline constexpr size_t kMinScanBlock        = 16384;
+    inline constexpr size_t kScanBlocksPerWorker = 8;
 } // namespace rts::core
\ No newline at end of file
@@ -3,25 +3,40 @@
  * @brief Defines the default thread pool implementation for the RTS runtime system.
  *
  * This thread pool manages a group of Worker threads that execute submitted Tasks.
- * Tasks are distributed in a round-robin fashion across the workers' local queues.
+ * Tasks are distributed in a round-robin fashion across the workers' inboxes, from
+ * any number of producer threads.
  *
  * @note The pool supports both hard and soft shutdown modes via the shared stop_flag_.
+ *       Idle workers either spin or park depending on the pool's IdleMode, and steal
+ *       from topologically close workers before distant ones.
  */
 
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cassert>
+#include <condition_variable>
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <ostream>
+#include <stop_token>
 #include <thread>
 #include <utility>
 #include <vector>
 
 #include "constants.h"
+#include "latency.h"
+#include "metrics.h"
+#include "parker.h"
+#include "profile.h"
+#include "stats.h"
 #include "task.h"
 #include "thread_pool.h"
+#include "topology.h"
+#include "trace.h"
 #include "worker.h"
 #include "utils.h"
 
@@ -31,8 +46,9 @@ namespace rts::core {
      * @brief The default thread pool used by MiniRTS.
      *
      * This pool owns and manages a fixed number of Worker threads.
-     * Each Worker maintains its own work-stealing queue, and tasks are
-     * enqueued in a round-robin pattern to balance load.
+     * Each Worker maintains its own work-stealing queue and a multi-producer
+     * inbox. Every producer thread walks the inboxes in round-robin order,
+     * starting from its own offset, to balance load without a shared cursor.
      *
      * The pool can be safely initialized and finalized multiple times
      * (using soft or hard shutdown), and supports basic saturation metrics.
@@ -43,8 +59,38 @@ namespace rts::core {
         size_t num_threads_;                                    ///< Number of threads in the pool.
         std::shared_ptr<std::atomic<int>> stop_flag_;           ///< Shared shutdown flag.
         std::shared_ptr<std::atomic<int>> active_workers_;      ///< Count of currently active workers.
-        int round_robin_;                                       ///< Index for round-robin scheduling.
+        std::shared_ptr<IdleCounters> idle_counters_;           ///< Spinning/sleeping worker counts.
         size_t queue_capacity_;                                 ///< Per-worker queue capacity.
+        IdleMode idle_mode_;                                    ///< Behaviour of idle workers.
+        TraceClock start_clock_ {};                             ///< Taken by init(): trace origin, TSC rate reference.
+        MetricsSegment metrics_;                                ///< Shared-memory copy of stats() (if metrics_segment is set).
+        std::jthread metrics_publisher_;                        ///< Refreshes metrics_ every metrics_period.
+
+        /// @brief Hands out the starting worker of each new producer thread.
+        static inline std::atomic<size_t> next_producer_{0};
+
+        /**
+         * @brief Wakes every parked worker (e.g. so that it observes a shutdown request).
+         */
+        void unpark_all() const noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (auto& worker : *workers_) {
+                worker.unpark();
+            }
+        }
+
+        /**
+         * @brief Publishes stats() to metrics_ every `period` until stopped.
+         */
+        void publish_metrics(std::stop_token stop, std::chrono::milliseconds period) {
+            std::mutex mutex;
+            std::condition_variable_any wake;
+            std::unique_lock lock(mutex);
+            while (!stop.stop_requested()) {
+                metrics_.publish(stats());
+                wake.wait_for(lock, stop, period, [] { return false; });   // Only woken by stop.
+            }
+        }
 
 
     public:
@@ -52,16 +98,19 @@ namespace rts::core {
          * @brief Constructs a thread pool with the given number of threads and queue capacity.
          * @param num_threads Number of worker threads to spawn (defaults to hardware concurrency).
          * @param queue_capacity Capacity for each worker’s local queue.
+         * @param idle_mode Whether idle workers spin forever or park after an adaptive spin window.
          */
         explicit DefaultThreadPool(
             size_t num_threads = kDefaultWorkerCount,
-            size_t queue_capacity = kDefaultCapacity) noexcept
+            size_t queue_capacity = kDefaultCapacity,
+            IdleMode idle_mode = kDefaultIdleMode) noexcept
             : workers_(std::make_shared<std::vector<Worker>>()),
               num_threads_(num_threads),
               stop_flag_(std::make_shared<std::atomic<int>>(0)),
               active_workers_(std::make_shared<std::atomic<int>>(0)),
-              round_robin_(0),
-              queue_capacity_(queue_capacity)
+              idle_counters_(std::make_shared<IdleCounters>()),
+              queue_capacity_(queue_capacity),
+              idle_mode_(idle_mode)
         {
             assert(num_threads_ > 0 && "ThreadPool must have at least one thread");
             assert(queue_capacity_ > 0 && "Queue capacity must be non-zero");
@@ -83,6 +132,7 @@ namespace rts::core {
             if (!workers_ || workers_->empty()) return;
 
             stop_flag_->store(HARD_SHUTDOWN, std::memory_order_release);
+            unpark_all();
             for (auto& worker : *workers_) {
                 worker.join();
             }
@@ -98,6 +148,8 @@ namespace rts::core {
             assert(workers_->empty() && "ThreadPool::init() called twice without finalize()");
             assert(num_threads_ > 0);
 
+            start_clock_ = TraceClock::now();
+            const Topology& topology = Topology::system();
             workers_->reserve(num_threads_);
             for (size_t i = 0; i < num_threads_; ++i) {
                 workers_->emplace_back(
@@ -105,13 +157,26 @@ namespace rts::core {
                     stop_flag_,
                     queue_capacity_,
                     workers_,
-                    active_workers_);
+                    active_workers_,
+                    idle_counters_,
+                    idle_mode_,
+                    topology.victim_tiers(i, num_threads_));
             }
 
             for (size_t i = 0; i < num_threads_; ++i) {
                 (*workers_)[i].run(num_threads_);
             }
 
+            if (!metrics_segment.empty()) {
+                if (metrics_.create(metrics_segment, num_threads_)) {
+                    metrics_publisher_ = std::jthread([this, period = metrics_period](std::stop_token stop) {
+                        publish_metrics(std::move(stop), period);
+                    });
+                } else {
+                    debug_print() << "Warning: could not create metrics segment " << metrics_segment << "\n";
+                }
+            }
+
             assert(workers_->size() == num_threads_ && "Worker initialization incomplete");
         }
 
@@ -119,14 +184,44 @@ namespace rts::core {
          * @brief Requests a shutdown and waits for all workers to finish.
          * @param mode Shutdown mode: HARD_SHUTDOWN or SOFT_SHUTDOWN.
          */
-        void finalize(ShutdownMode mode) const noexcept {
+        void finalize(ShutdownMode mode) noexcept {
             assert(workers_ && "finalize() called before init()");
             assert(!workers_->empty() && "finalize() called with no active workers");
             stop_flag_->store(mode, std::memory_order_release);
+            unpark_all();
 
             for (auto& worker : *workers_) {
                 worker.join();
             }
+
+            if (metrics_publisher_.joinable()) {
+                metrics_publisher_.request_stop();
+                metrics_publisher_.join();
+            }
+            metrics_.close();
+
+            if constexpr (kTracing) {
+                if (!trace_file.empty()) {
+                    std::ofstream out(trace_file);
+                    write_trace(out);
+                }
+            }
+        }
+
+        /**
+         * @brief Writes the retained events of every worker as Chrome trace JSON.
+         *
+         * May run while the workers keep going. Without kTracing the trace has no events.
+         */
+        void write_trace(std::ostream& out) const {
+            assert(workers_ && "write_trace() called before init()");
+
+            std::vector<std::vector<TraceRecord>> events;
+            events.reserve(workers_->size());
+            for (const Worker& wkr : *workers_) {
+                events.push_back(wkr.trace() ? wkr.trace()->snapshot() : std::vector<TraceRecord>{});
+            }
+            write_chrome_trace(out, events, start_clock_, TraceClock::now());
         }
 
         /**
@@ -149,22 +244,99 @@ namespace rts::core {
         }
 
         /**
-         * @brief Enqueues a Task into the next worker’s local queue.
+         * @brief Reads every worker's scheduler counters, without stopping the workers.
+         */
+        [[nodiscard]] RuntimeStats stats() const {
+            assert(workers_ && "stats() called before init()");
+
+            RuntimeStats snapshot;
+            snapshot.workers.reserve(workers_->size());
+            for (const Worker& wkr : *workers_) {
+                snapshot.workers.push_back(WorkerStats::load(wkr.counters()));
+                snapshot.workers.back().wsq_depth = wkr.wsq_size();
+                snapshot.workers.back().inbox_depth = wkr.inbox_size();
+                snapshot.total += snapshot.workers.back();
+            }
+            snapshot.saturation = compute_saturation();
+            return snapshot;
+        }
+
+        /**
+         * @brief Merges every worker's latency histograms, without stopping the workers.
+         *
+         * Ticks are converted to nanoseconds with the TSC rate observed since init().
+         * Without kLatencyStats the distributions are empty.
+         */
+        [[nodiscard]] LatencyStats latency_stats() const {
+            assert(workers_ && "latency_stats() called before init()");
+
+            const TraceClock now = TraceClock::now();
+            const double elapsed_ns = std::chrono::duration<double, std::nano>(now.time - start_clock_.time).count();
+            const double ns_per_tick = now.tsc > start_clock_.tsc
+                                     ? elapsed_ns / static_cast<double>(now.tsc - start_clock_.tsc) : 0.0;
+
+            LatencyStats snapshot;
+            snapshot.enqueue_to_start.ns_per_tick = ns_per_tick;
+            snapshot.spawn_to_ready.ns_per_tick = ns_per_tick;
+            for (const Worker& wkr : *workers_) {
+                if (const WorkerLatency* latency = wkr.latency()) {
+                    latency->enqueue_to_start.add_to(snapshot.enqueue_to_start.counts);
+                    latency->spawn_to_ready.add_to(snapshot.spawn_to_ready.counts);
+                }
+            }
+            return snapshot;
+        }
+
+        /**
+         * @brief Reads the time every worker spent in each phase of its scheduling loop,
+         *        without stopping the workers. Without kProfile every phase is zero.
+         */
+        [[nodiscard]] ProfileReport profile() const {
+            assert(workers_ && "profile() called before init()");
+
+            ProfileReport report;
+            report.workers.reserve(workers_->size());
+            for (const Worker& wkr : *workers_) {
+                report.workers.push_back(wkr.profile() ? PhaseStats::load(*wkr.profile()) : PhaseStats{});
+                report.total += report.workers.back();
+            }
+            return report;
+        }
+
+        /**
+         * @brief Enqueues a Task into the next worker’s inbox.
+         *
+         * Tasks are assigned in round-robin order for load distribution. Each producer
+         * thread keeps its own cursor, registered on its first call, so that concurrent
+         * producers start on different workers. If the chosen inbox is full the next
+         * ones are tried, and the call spins only when every inbox is full.
+         * The receiving worker is woken up if it is parked.
          *
-         * Tasks are assigned in round-robin order for load distribution.
          * @param task The task to enqueue.
+         * @note Thread-safe: may be called from any number of threads, including workers.
          */
         void enqueue(Task &&task) noexcept {
             assert(workers_ && "enqueue() called before init()");
             assert(!workers_->empty() && "enqueue() called on empty ThreadPool");
             assert(task && "enqueue() received an empty Task");
 
-            (*workers_)[round_robin_].enqueue(std::move(task));
+            thread_local size_t cursor = next_producer_.fetch_add(1, std::memory_order_relaxed);
+            if (cursor >= num_threads_) {
+                cursor %= num_threads_;
+            }
 
-            round_robin_++;
-            if (round_robin_ >= static_cast<int>(num_threads_)) {
-                round_robin_ = 0;
+            task.mark_submitted();
+            const size_t first = cursor;
+            size_t target = first;
+            while (!(*workers_)[target].try_enqueue(std::move(task))) {
+                if (++target == num_threads_)
+                    target = 0;
+                if (target == first)
+                    pause_hint();   // Every inbox is full: apply backpressure.
             }
+
+            if (++cursor == num_threads_)
+                cursor = 0;
         }
     };
 
@@ -0,0 +1,129 @@
+/**
+ * @file latency.h
+ * @brief Log-linear latency histograms kept by every worker, and the distributions
+ *        returned by rts::latency_stats().
+ *
+ * When built with kLatencyStats, every Task carries the read_tsc() tick of its submission.
+ * The worker that runs it records the delay until the task starts, and spawn() records
+ * the delay until its Future becomes ready. Each worker has its own histograms; they
+ * are merged on demand.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Histogram of tick counts with a bounded relative error (HDR-style log-linear buckets).
+     *
+     * Values below kSubBuckets have a bucket each; every power of two above is split in
+     * kSubBuckets linear buckets, so a bucket spans at most 1/kSubBuckets of its values.
+     * Written by one worker with relaxed stores (like WorkerCounters) and readable at any time.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr unsigned kSubBucketBits = 5;
+        static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+        static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+        /// @brief Index of the bucket holding `value`.
+        static constexpr size_t bucket_of(uint64_t value) noexcept {
+            if (value < kSubBuckets)
+                return static_cast<size_t>(value);
+            const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - kSubBucketBits;
+            return (shift + 1) * kSubBuckets + static_cast<size_t>((value >> shift) - kSubBuckets);
+        }
+
+        /// @brief Largest value held by `bucket`.
+        static constexpr uint64_t bucket_max(size_t bucket) noexcept {
+            if (bucket < kSubBuckets)
+                return bucket;
+            const size_t shift = bucket / kSubBuckets - 1;
+            const uint64_t low = static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+            return low + ((uint64_t{1} << shift) - 1);
+        }
+
+        /// @brief Counts `value`. Must be called from the owning worker's thread.
+        void record(uint64_t value) noexcept {
+            std::atomic<uint64_t>& count = counts_[bucket_of(value)];
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /// @brief Adds the counts to `counts` (resized to kBuckets), without stopping the worker.
+        void add_to(std::vector<uint64_t>& counts) const {
+            counts.resize(kBuckets);
+            for (size_t i = 0; i < kBuckets; ++i)
+                counts[i] += counts_[i].load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, kBuckets> counts_ {};
+    };
+
+    /**
+     * @brief Histograms of one worker.
+     */
+    struct alignas(kCacheLine) WorkerLatency {
+        LatencyHistogram enqueue_to_start;   ///< Submission of a task until a worker starts it.
+        LatencyHistogram spawn_to_ready;     ///< spawn() until its Future is ready.
+    };
+
+    /**
+     * @brief Merged counts of LatencyHistograms, read as nanoseconds.
+     */
+    struct LatencyDistribution {
+        std::vector<uint64_t> counts;   ///< Per LatencyHistogram bucket (empty when nothing was read).
+        double ns_per_tick = 0.0;       ///< Rate of read_tsc() observed by the pool.
+
+        /// @brief Number of recorded values.
+        [[nodiscard]] uint64_t count() const noexcept {
+            uint64_t total = 0;
+            for (uint64_t c : counts)
+                total += c;
+            return total;
+        }
+
+        /**
+         * @brief Value below or at which `percent` % of the recorded values lie, in nanoseconds
+         *        (0 if nothing was recorded).
+         *
+         * Reported as the top of its bucket, so it overestimates by less than 1/kSubBuckets.
+         */
+        [[nodiscard]] double percentile(double percent) const noexcept {
+            const uint64_t total = count();
+            if (total == 0)
+                return 0.0;
+            const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(
+                std::clamp(percent, 0.0, 100.0) / 100.0 * static_cast<double>(total) + 0.5));
+            uint64_t seen = 0;
+            size_t bucket = 0;
+            while ((seen += counts[bucket]) < rank)
+                ++bucket;
+            return static_cast<double>(LatencyHistogram::bucket_max(bucket)) * ns_per_tick;
+        }
+
+        /// @brief Largest recorded value, in nanoseconds (0 if nothing was recorded).
+        [[nodiscard]] double max() const noexcept {
+            return percentile(100.0);
+        }
+    };
+
+    /**
+     * @brief Snapshot of the runtime's scheduling latencies, merged over the workers.
+     */
+    struct LatencyStats {
+        LatencyDistribution enqueue_to_start;   ///< rts::enqueue(), spawn() or a continuation until the task starts.
+        LatencyDistribution spawn_to_ready;     ///< spawn() until its Future is ready.
+    };
+
+} // namespace rts::core
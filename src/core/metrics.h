@@ -0,0 +1,329 @@
+/**
+ * @file metrics.h
+ * @brief Shared-memory segment through which a running pool publishes its scheduler
+ *        counters, and from which `rts-top` reads them.
+ *
+ * The segment is a POSIX shared-memory object (under /dev/shm on Linux) holding a
+ * MetricsHeader followed by one MetricsSlot per worker. A single publisher
+ * thread of the pool copies rts::stats() into it periodically, under a seqlock: readers
+ * in other processes never block it, and retry when they overlap an update.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+
+#if defined(__unix__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "constants.h"
+#include "stats.h"
+#include "utils.h"
+
+namespace rts::core {
+
+    /// @brief Identifies a MiniRTS metrics segment ("MRTSMTRC").
+    inline constexpr uint64_t kMetricsMagic = 0x4352544D5354524Dull;
+
+    /// @brief Bumped whenever the layout of the segment changes.
+    inline constexpr uint32_t kMetricsVersion = 2;
+
+    /// @brief Default interval between two publications of the counters.
+    inline constexpr std::chrono::milliseconds kMetricsPeriod {100};
+
+    /// @brief How long a reader waits for an update in progress before giving up on it.
+    inline constexpr std::chrono::milliseconds kMetricsReadTimeout {50};
+
+    /**
+     * @brief Start of a metrics segment. The MetricsSlot of every worker follows it.
+     *
+     * The constant fields are written before the segment is made visible; the others are
+     * covered by `sequence`, which is odd while the publisher updates the segment.
+     */
+    struct alignas(kCacheLine) MetricsHeader {
+        uint64_t magic;                                 ///< kMetricsMagic.
+        uint32_t version;                               ///< kMetricsVersion.
+        uint32_t num_workers;                           ///< Number of MetricsSlots that follow.
+        uint64_t slot_size;                             ///< sizeof(MetricsSlot) of the publisher.
+        int64_t pid;                                    ///< Publishing process.
+        std::atomic<uint64_t> sequence {0};             ///< Seqlock: odd while being written.
+        std::atomic<uint64_t> published_at_ns {0};      ///< steady_clock time of the last publication.
+        std::atomic<uint64_t> saturation_bits {0};      ///< RuntimeStats::saturation, as the bits of a double.
+    };
+
+    /**
+     * @brief Published state of one worker: its counters and the depth of its queues.
+     */
+    struct alignas(kCacheLine) MetricsSlot {
+        WorkerCounters counters;
+        std::atomic<uint64_t> wsq_depth {0};
+        std::atomic<uint64_t> inbox_depth {0};
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "The metrics segment is shared across processes and needs address-free atomics");
+
+    /**
+     * @brief Counters read from a metrics segment, with the time they were published at.
+     */
+    struct MetricsSnapshot {
+        RuntimeStats stats;
+        uint64_t published_at_ns = 0;   ///< steady_clock time since epoch, in nanoseconds.
+        int64_t pid = 0;                ///< Process that published them.
+    };
+
+    /**
+     * @brief Returns the name of the segment `rts-top` attaches to for process `pid`.
+     */
+    inline std::string metrics_segment_for(int64_t pid) {
+        return "/minirts." + std::to_string(pid);
+    }
+
+    /**
+     * @brief A mapping of a metrics segment, either created by a publisher or opened by a reader.
+     *
+     * The creator is the only writer, and removes the segment when destroyed. Move-only.
+     * Only available on POSIX systems; elsewhere create() and open() fail.
+     */
+    class MetricsSegment {
+        void* base_ = nullptr;      ///< Start of the mapping.
+        size_t size_ = 0;           ///< Length of the mapping in bytes.
+        std::string name_;          ///< Shared-memory object name (unlinked on destruction if owner_).
+        bool owner_ = false;        ///< Whether this mapping created the segment.
+
+        [[nodiscard]] MetricsHeader& header() const noexcept {
+            return *static_cast<MetricsHeader*>(base_);
+        }
+
+        [[nodiscard]] MetricsSlot* slots() const noexcept {
+            return reinterpret_cast<MetricsSlot*>(static_cast<unsigned char*>(base_) + sizeof(MetricsHeader));
+        }
+
+        static constexpr size_t size_for(size_t num_workers) noexcept {
+            return sizeof(MetricsHeader) + num_workers * sizeof(MetricsSlot);
+        }
+
+    public:
+        MetricsSegment() noexcept = default;
+
+        MetricsSegment(const MetricsSegment&) = delete;
+        MetricsSegment& operator=(const MetricsSegment&) = delete;
+
+        MetricsSegment(MetricsSegment&& other) noexcept
+            : base_(std::exchange(other.base_, nullptr)),
+              size_(std::exchange(other.size_, 0)),
+              name_(std::move(other.name_)),
+              owner_(std::exchange(other.owner_, false)) {}
+
+        MetricsSegment& operator=(MetricsSegment&& other) noexcept {
+            if (this != &other) {
+                close();
+                base_ = std::exchange(other.base_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+                name_ = std::move(other.name_);
+                owner_ = std::exchange(other.owner_, false);
+            }
+            return *this;
+        }
+
+        ~MetricsSegment() noexcept {
+            close();
+        }
+
+        /**
+         * @brief Creates (or replaces) the segment `name` for `num_workers` workers, zeroed.
+         * @return False if the shared-memory object could not be created or mapped.
+         */
+        bool create(const std::string& name, size_t num_workers) noexcept {
+            close();
+#if defined(__unix__)
+            shm_unlink(name.c_str());   // A previous run with the same pid may have crashed.
+            const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+            if (fd < 0)
+                return false;
+
+            const size_t size = size_for(num_workers);
+            void* base = ftruncate(fd, static_cast<off_t>(size)) == 0
+                       ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                       : MAP_FAILED;
+            ::close(fd);
+            if (base == MAP_FAILED) {
+                shm_unlink(name.c_str());
+                return false;
+            }
+
+            base_ = base;
+            size_ = size;
+            name_ = name;
+            owner_ = true;
+
+            auto* hdr = new (base_) MetricsHeader {};
+            hdr->magic = kMetricsMagic;
+            hdr->version = kMetricsVersion;
+            hdr->num_workers = static_cast<uint32_t>(num_workers);
+            hdr->slot_size = sizeof(MetricsSlot);
+            hdr->pid = static_cast<int64_t>(getpid());
+            for (size_t i = 0; i < num_workers; ++i)
+                new (slots() + i) MetricsSlot {};
+            return true;
+#else
+            (void)name;
+            (void)num_workers;
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Maps the existing segment `name` read-only.
+         * @return False if it does not exist or was not published by a compatible runtime.
+         */
+        bool open(const std::string& name) noexcept {
+            close();
+#if defined(__unix__)
+            const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0)
+                return false;
+
+            struct stat st {};
+            void* base = MAP_FAILED;
+            if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(MetricsHeader))
+                base = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED)
+                return false;
+
+            base_ = base;
+            size_ = static_cast<size_t>(st.st_size);
+            name_ = name;
+            const MetricsHeader& hdr = header();
+            if (hdr.magic != kMetricsMagic || hdr.version != kMetricsVersion
+                || hdr.slot_size != sizeof(MetricsSlot) || size_ < size_for(hdr.num_workers)) {
+                close();
+                return false;
+            }
+            return true;
+#else
+            (void)name;
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Unmaps the segment, and removes it if this mapping created it.
+         */
+        void close() noexcept {
+#if defined(__unix__)
+            if (base_) {
+                munmap(base_, size_);
+                if (owner_)
+                    shm_unlink(name_.c_str());
+            }
+#endif
+            base_ = nullptr;
+            size_ = 0;
+            owner_ = false;
+        }
+
+        /// @brief Whether a segment is mapped.
+        [[nodiscard]] explicit operator bool() const noexcept {
+            return base_ != nullptr;
+        }
+
+        /**
+         * @brief Copies `stats` into the segment.
+         * @note Only the creator may call it, from one thread at a time.
+         */
+        void publish(const RuntimeStats& stats) noexcept {
+            assert(owner_ && "publish() called on a segment opened for reading");
+            constexpr auto relaxed = std::memory_order_relaxed;
+
+            MetricsHeader& hdr = header();
+            const uint64_t seq = hdr.sequence.load(relaxed);
+            hdr.sequence.store(seq + 1, relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            const size_t n = std::min<size_t>(hdr.num_workers, stats.workers.size());
+            for (size_t i = 0; i < n; ++i) {
+                const WorkerStats& from = stats.workers[i];
+                WorkerCounters& to = slots()[i].counters;
+                to.tasks_executed.store(from.tasks_executed, relaxed);
+                to.local_pops.store(from.local_pops, relaxed);
+                to.local_pushes.store(from.local_pushes, relaxed);
+                to.inbox_transfers.store(from.inbox_transfers, relaxed);
+                to.steal_attempts.store(from.steal_attempts, relaxed);
+                to.steal_successes.store(from.steal_successes, relaxed);
+                to.tasks_stolen.store(from.tasks_stolen, relaxed);
+                to.idle_iterations.store(from.idle_iterations, relaxed);
+                to.parks.store(from.parks, relaxed);
+                slots()[i].wsq_depth.store(from.wsq_depth, relaxed);
+                slots()[i].inbox_depth.store(from.inbox_depth, relaxed);
+            }
+            hdr.saturation_bits.store(std::bit_cast<uint64_t>(stats.saturation), relaxed);
+            hdr.published_at_ns.store(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count()), relaxed);
+
+            hdr.sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        /**
+         * @brief Reads a consistent copy of the segment, retrying while the publisher updates it.
+         * @return Nothing if no segment is mapped, or if the segment stayed mid-update for
+         *         kMetricsReadTimeout (its publisher was killed while writing it).
+         */
+        [[nodiscard]] std::optional<MetricsSnapshot> read() const {
+            if (!base_)
+                return std::nullopt;
+
+            const MetricsHeader& hdr = header();
+            MetricsSnapshot snapshot;
+            snapshot.pid = hdr.pid;
+            snapshot.stats.workers.resize(hdr.num_workers);
+            const auto deadline = std::chrono::steady_clock::now() + kMetricsReadTimeout;
+            for (;;) {
+                const uint64_t seq = hdr.sequence.load(std::memory_order_acquire);
+                if (seq & 1) {
+                    if (std::chrono::steady_clock::now() > deadline)
+                        return std::nullopt;
+                    pause_hint();
+                    continue;
+                }
+
+                snapshot.stats.total = {};
+                for (size_t i = 0; i < hdr.num_workers; ++i) {
+                    const MetricsSlot& slot = slots()[i];
+                    snapshot.stats.workers[i] = WorkerStats::load(slot.counters);
+                    snapshot.stats.workers[i].wsq_depth = slot.wsq_depth.load(std::memory_order_relaxed);
+                    snapshot.stats.workers[i].inbox_depth = slot.inbox_depth.load(std::memory_order_relaxed);
+                    snapshot.stats.total += snapshot.stats.workers[i];
+                }
+                snapshot.stats.saturation = std::bit_cast<double>(hdr.saturation_bits.load(std::memory_order_relaxed));
+                snapshot.published_at_ns = hdr.published_at_ns.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (hdr.sequence.load(std::memory_order_relaxed) == seq)
+                    return snapshot;
+            }
+        }
+    };
+
+    /// @brief Name of the segment the pool publishes its counters to (empty, the default: none).
+    inline std::string metrics_segment;
+
+    /// @brief Interval between two publications to metrics_segment.
+    inline std::chrono::milliseconds metrics_period = kMetricsPeriod;
+
+} // namespace rts::core
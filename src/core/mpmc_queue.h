@@ -0,0 +1,155 @@
+/**
+ * @file mpmc_queue.h
+ * @brief Defines a bounded, lock-free multi-producer multi-consumer queue.
+ *
+ * The queue is the per-worker inbox through which tasks submitted from outside
+ * the worker (`rts::enqueue`, `spawn`, ...) reach it. Any number of threads may
+ * push concurrently; in MiniRTS only the owning worker pops.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence
+ * number that tells producers and consumers whether the cell is free or full
+ * for the current lap, so each push and pop costs a single CAS on the
+ * corresponding position counter.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "constants.h"
+#include "utils.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Bounded lock-free MPMC queue with power-of-two capacity.
+     *
+     * @tparam T Element type. Must be default-constructible and move-assignable.
+     */
+    template <typename T>
+    class MPMCQueue {
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> cells_;                         ///< Ring of cells.
+        size_t mask_;                                           ///< Capacity - 1.
+        alignas(kCacheLine) std::atomic<size_t> enqueue_pos_{0};    ///< Next position to push.
+        alignas(kCacheLine) std::atomic<size_t> dequeue_pos_{0};    ///< Next position to pop.
+
+        static size_t round_up_pow2(size_t n) noexcept {
+            size_t cap = 2;
+            while (cap < n) cap <<= 1;
+            return cap;
+        }
+
+    public:
+        /**
+         * @brief Constructs a queue holding at least `capacity` elements.
+         * @param capacity Requested capacity (rounded up to a power of two).
+         */
+        explicit MPMCQueue(size_t capacity)
+            : cells_(std::make_unique<Cell[]>(round_up_pow2(capacity))),
+              mask_(round_up_pow2(capacity) - 1) {
+            assert(capacity > 0 && "MPMCQueue capacity must be non-zero");
+            for (size_t i = 0; i <= mask_; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MPMCQueue(const MPMCQueue&) = delete;
+        MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+        /**
+         * @brief Attempts to construct an element at the tail of the queue.
+         * @return False if the queue is full (the arguments are left untouched).
+         * @note Safe to call from any number of threads concurrently.
+         */
+        template <typename... Args>
+        bool try_emplace(Args&&... args) noexcept {
+            size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells_[pos & mask_];
+                const size_t seq = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;   // Full
+                } else {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            Cell& cell = cells_[pos & mask_];
+            cell.data = T(std::forward<Args>(args)...);
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Constructs an element at the tail, spinning while the queue is full.
+         */
+        template <typename... Args>
+        void emplace(Args&&... args) noexcept {
+            while (!try_emplace(std::forward<Args>(args)...)) {
+                pause_hint();
+            }
+        }
+
+        /**
+         * @brief Attempts to pop the element at the head of the queue.
+         * @param out Receives the element on success.
+         * @return False if the queue is empty.
+         */
+        bool try_pop(T& out) noexcept {
+            size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells_[pos & mask_];
+                const size_t seq = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+                if (diff == 0) {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;   // Empty
+                } else {
+                    pos = dequeue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+            Cell& cell = cells_[pos & mask_];
+            out = std::move(cell.data);
+            cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Returns an approximation of the number of queued elements.
+         */
+        [[nodiscard]] size_t size() const noexcept {
+            const size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+            const size_t head = dequeue_pos_.load(std::memory_order_acquire);
+            return tail > head ? tail - head : 0;
+        }
+
+        /**
+         * @brief Returns true if the queue appears empty.
+         */
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         * @brief Returns the maximum number of elements the queue can hold.
+         */
+        [[nodiscard]] size_t capacity() const noexcept {
+            return mask_ + 1;
+        }
+    };
+
+} // namespace rts::core
@@ -0,0 +1,96 @@
+/**
+ * @file parker.h
+ * @brief Defines the primitives used by idle workers to park and be woken up.
+ *
+ * A Worker that runs out of work spins for a bounded window and then parks on
+ * its Parker, which blocks on `std::atomic::wait` (a futex on Linux). Producers
+ * publish a Task first and then unpark the target worker, so a wake-up can never
+ * be lost: both sides issue a sequentially-consistent fence between publishing
+ * their own state and reading the other side's.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "constants.h"
+
+namespace rts::core {
+
+    /**
+     * @brief A single-waiter parking spot owned by one Worker.
+     *
+     * Only the owning worker calls `prepare_park()`, `cancel_park()` and `park()`.
+     * Any thread may call `unpark()`.
+     */
+    class alignas(kCacheLine) Parker {
+        static constexpr std::uint32_t AWAKE  = 0;
+        static constexpr std::uint32_t PARKED = 1;
+
+        std::atomic<std::uint32_t> state_{AWAKE};   ///< Futex word.
+
+    public:
+        /**
+         * @brief Announces that the owner is about to park.
+         *
+         * The owner must re-check for work after this call and before `park()`.
+         */
+        void prepare_park() noexcept {
+            state_.store(PARKED, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief Withdraws a previous `prepare_park()` after work was found.
+         */
+        void cancel_park() noexcept {
+            state_.store(AWAKE, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Blocks the owner until another thread calls `unpark()`.
+         */
+        void park() noexcept {
+            while (state_.load(std::memory_order_acquire) == PARKED) {
+                state_.wait(PARKED, std::memory_order_acquire);
+            }
+        }
+
+        /**
+         * @brief Wakes the owner if it is parked (or about to park).
+         *
+         * The caller must have published its work and issued a seq_cst fence beforehand.
+         * @return True if the owner was parked and has been notified.
+         */
+        bool unpark() noexcept {
+            if (state_.load(std::memory_order_relaxed) != PARKED)
+                return false;
+            if (state_.exchange(AWAKE, std::memory_order_acq_rel) != PARKED)
+                return false;
+            state_.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Returns true if the owner has announced that it is parking.
+         */
+        [[nodiscard]] bool is_parked() const noexcept {
+            return state_.load(std::memory_order_relaxed) == PARKED;
+        }
+    };
+
+    /**
+     * @brief Pool-wide idle bookkeeping shared by all workers.
+     *
+     * `spinning` counts workers that are idle but still polling for work;
+     * `sleeping` counts workers that are parked or about to park. A producer only
+     * needs to wake a sleeper when nobody is spinning, since a spinning worker
+     * will find the new Task on its own.
+     */
+    struct IdleCounters {
+        alignas(kCacheLine) std::atomic<int> spinning{0};
+        alignas(kCacheLine) std::atomic<int> sleeping{0};
+    };
+
+} // namespace rts::core
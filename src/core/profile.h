@@ -0,0 +1,198 @@
+/**
+ * @file profile.h
+ * @brief Per-worker breakdown of where the scheduling loop spends its time, and the
+ *        report returned by rts::profile().
+ *
+ * When built with kProfile, Worker::run() reads the time-stamp counter at every phase
+ * boundary of its loop and adds the elapsed ticks to the phase: popping the WSQ,
+ * stealing (failed or successful), moving tasks from the inbox, running tasks, and idling.
+ * Once a worker has found no work, further polling of its queues and failed steal scans
+ * count as idling, so a pool without work reports no overhead. Tasks run while helping
+ * in Future::wait() count towards the task that waits.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+#include "utils.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Phases of a worker's scheduling loop.
+     */
+    enum class Phase : uint8_t {
+        POP,          ///< Popping a task from the worker's own WSQ (a pop that finds it empty is IDLE).
+        STEAL_SCAN,   ///< Steal attempts that found nothing, right after running out of work.
+        STEAL,        ///< Steal attempts that took tasks.
+        TRANSFER,     ///< Moving tasks from the inbox to the WSQ (a drain that moves none is IDLE).
+        EXECUTE,      ///< Running tasks (and the continuations they run inline).
+        IDLE,         ///< Polling empty queues, repeated failed steal scans, spinning or parked.
+    };
+
+    inline constexpr size_t kPhases = 6;
+
+    /// @brief Column headers of write_profile_report(), in Phase order.
+    inline constexpr std::array<const char*, kPhases> kPhaseNames {
+        "pop", "steal scan", "steal", "transfer", "execute", "idle"
+    };
+
+    /**
+     * @brief Ticks spent in each Phase by one worker.
+     *
+     * Written by the worker's own thread with relaxed stores (like WorkerCounters),
+     * readable at any time.
+     */
+    struct alignas(kCacheLine) WorkerProfile {
+        std::array<std::atomic<uint64_t>, kPhases> ticks {};
+
+        /// @brief Adds `n` ticks to `phase`. Must be called from the owning worker's thread.
+        void add(Phase phase, uint64_t n) noexcept {
+            std::atomic<uint64_t>& t = ticks[static_cast<size_t>(phase)];
+            t.store(t.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Charges the time between consecutive laps to phases of a WorkerProfile.
+     *
+     * Compiles to nothing unless kProfile.
+     */
+    class PhaseTimer {
+        WorkerProfile* profile_;
+        uint64_t mark_;
+
+    public:
+        explicit PhaseTimer(WorkerProfile* profile) noexcept
+            : profile_(profile), mark_(kProfile ? read_tsc() : 0) {}
+
+        /// @brief Charges the ticks since the previous lap to `phase`.
+        void lap(Phase phase) noexcept {
+            if constexpr (kProfile) {
+                const uint64_t now = read_tsc();
+                profile_->add(phase, now - mark_);
+                mark_ = now;
+            }
+        }
+    };
+
+    /**
+     * @brief Values of a WorkerProfile at one point in time (or summed over workers).
+     */
+    struct PhaseStats {
+        std::array<uint64_t, kPhases> ticks {};
+
+        /// @brief Reads `profile` without stopping its worker.
+        static PhaseStats load(const WorkerProfile& profile) noexcept {
+            PhaseStats stats;
+            for (size_t i = 0; i < kPhases; ++i)
+                stats.ticks[i] = profile.ticks[i].load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        [[nodiscard]] uint64_t operator[](Phase phase) const noexcept {
+            return ticks[static_cast<size_t>(phase)];
+        }
+
+        /// @brief Ticks over every phase.
+        [[nodiscard]] uint64_t total() const noexcept {
+            uint64_t sum = 0;
+            for (uint64_t t : ticks)
+                sum += t;
+            return sum;
+        }
+
+        /// @brief Ticks spent scheduling: popping, stealing and draining the inbox.
+        [[nodiscard]] uint64_t scheduling() const noexcept {
+            return (*this)[Phase::POP] + (*this)[Phase::STEAL_SCAN] + (*this)[Phase::STEAL] + (*this)[Phase::TRANSFER];
+        }
+
+        /**
+         * @brief Share of the busy (non-idle) time spent scheduling rather than running tasks,
+         *        between 0 and 1.
+         */
+        [[nodiscard]] double overhead() const noexcept {
+            const uint64_t busy = scheduling() + (*this)[Phase::EXECUTE];
+            return busy ? static_cast<double>(scheduling()) / static_cast<double>(busy) : 0.0;
+        }
+
+        PhaseStats& operator+=(const PhaseStats& other) noexcept {
+            for (size_t i = 0; i < kPhases; ++i)
+                ticks[i] += other.ticks[i];
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Snapshot of the phase breakdown of every worker.
+     */
+    struct ProfileReport {
+        std::vector<PhaseStats> workers;   ///< One entry per worker, in pool order.
+        PhaseStats total;                  ///< Sum over the workers.
+    };
+
+    /**
+     * @brief Writes `report` as a table: the share of each phase in every worker's time,
+     *        and the scheduling overhead (see PhaseStats::overhead()).
+     */
+    inline void write_profile_report(std::ostream& out, const ProfileReport& report) {
+        const auto row = [&out](const std::string& label, const PhaseStats& stats) {
+            const uint64_t total = stats.total();
+            out << std::setw(8) << label;
+            for (uint64_t t : stats.ticks)
+                out << std::setw(11) << (total ? 100.0 * static_cast<double>(t) / static_cast<double>(total) : 0.0) << '%';
+            out << std::setw(11) << 100.0 * stats.overhead() << "%\n";
+        };
+
+        const std::ios_base::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(1) << std::setw(8) << "worker";
+        for (const char* name : kPhaseNames)
+            out << std::setw(12) << name;
+        out << std::setw(12) << "overhead" << '\n';
+        for (size_t i = 0; i < report.workers.size(); ++i)
+            row(std::to_string(i), report.workers[i]);
+        row("total", report.total);
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    /**
+     * @brief Phase breakdown of the workers that have exited, by worker index.
+     *
+     * Each worker adds its profile when its thread ends, so that a breakdown survives
+     * the runtime being finalized (e.g. between benchmark runs). Drain it with
+     * take_exited_profile().
+     */
+    inline std::mutex exited_profile_mutex;
+    inline ProfileReport exited_profile;
+
+    /// @brief Adds the profile of worker `index`, whose thread is exiting.
+    inline void retire_profile(size_t index, const PhaseStats& stats) {
+        std::lock_guard lock(exited_profile_mutex);
+        if (exited_profile.workers.size() <= index)
+            exited_profile.workers.resize(index + 1);
+        exited_profile.workers[index] += stats;
+        exited_profile.total += stats;
+    }
+
+    /// @brief Returns the profile of the workers that exited since the last call, and resets it.
+    inline ProfileReport take_exited_profile() {
+        std::lock_guard lock(exited_profile_mutex);
+        ProfileReport report = std::move(exited_profile);
+        exited_profile = {};
+        return report;
+    }
+
+} // namespace rts::core
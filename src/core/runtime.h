@@ -9,10 +9,14 @@
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
+#include <concepts>
 #include <exception>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <ostream>
+#include <string>
 #include <thread>
 #include <tuple>
 #include <type_traits>
@@ -20,8 +24,13 @@
 #include <vector>
 
 #include "concepts.h"
+#include "latency.h"
+#include "metrics.h"
+#include "profile.h"
+#include "stats.h"
 #include "task.h"
 #include "thread_pool.h"
+#include "trace.h"
 #include "constants.h"
 
 namespace rts::core {
@@ -43,6 +52,18 @@ namespace rts::core {
     /// @brief Function pointer bound to the runtime’s active finalize() implementation.
     inline void (*finalize_fn)(ShutdownMode mode) = nullptr;
 
+    /// @brief Function pointer bound to the active pool's stats() (null if the pool has none).
+    inline RuntimeStats (*stats_fn)() = nullptr;
+
+    /// @brief Function pointer bound to the active pool's write_trace() (null if the pool has none).
+    inline void (*trace_fn)(std::ostream&) = nullptr;
+
+    /// @brief Function pointer bound to the active pool's latency_stats() (null if the pool has none).
+    inline LatencyStats (*latency_fn)() = nullptr;
+
+    /// @brief Function pointer bound to the active pool's profile() (null if the pool has none).
+    inline ProfileReport (*profile_fn)() = nullptr;
+
     /// @brief Cached saturation metric for monitoring queue load (optional diagnostic).
     inline float saturation_cached = 0.0f;
 } // namespace rts::core
@@ -59,6 +80,7 @@ namespace rts
      * @tparam T ThreadPool implementation type (must satisfy ThreadPool concept).
      * @param num_threads Number of worker threads to spawn.
      * @param queue_capacity Per-worker queue capacity.
+     * @param idle_mode Behaviour of idle workers (ignored by pools that do not accept an IdleMode).
      * @return True if initialization succeeded, false if a runtime was already running.
      *
      * @note This function allocates the runtime pool on the heap and binds
@@ -66,7 +88,8 @@ namespace rts
      */
     template <core::ThreadPool T = core::DefaultThreadPool>
     bool initialize_runtime(size_t num_threads = core::kDefaultWorkerCount,
-                            size_t queue_capacity = core::kDefaultCapacity) noexcept {
+                            size_t queue_capacity = core::kDefaultCapacity,
+                            core::IdleMode idle_mode = core::kDefaultIdleMode) noexcept {
         bool expected = false;
 
         // Ensure only one runtime instance is active at a time.
@@ -76,7 +99,12 @@ namespace rts
             assert(!core::active_thread_pool && "Runtime already has an active thread pool");
             assert(!core::enqueue_fn && !core::finalize_fn && "Function pointers must be null before init");
 
-            auto* pool = new T(num_threads, queue_capacity);
+            T* pool;
+            if constexpr (std::is_nothrow_constructible_v<T, size_t, size_t, core::IdleMode>) {
+                pool = new T(num_threads, queue_capacity, idle_mode);
+            } else {
+                pool = new T(num_threads, queue_capacity);
+            }
             pool->init();  // User-defined startup logic for the pool.
 
             core::active_thread_pool = pool;
@@ -88,6 +116,38 @@ namespace rts
                 static_cast<T*>(core::active_thread_pool)->enqueue(std::move(task));
             };
 
+            // Bind stats function pointer, for pools that keep counters
+            if constexpr (requires(const T& t) { { t.stats() } -> std::same_as<core::RuntimeStats>; }) {
+                core::stats_fn = [] {
+                    assert(core::active_thread_pool && "No active thread pool set");
+                    return static_cast<const T*>(core::active_thread_pool)->stats();
+                };
+            }
+
+            // Bind trace function pointer, for pools that record a timeline
+            if constexpr (requires(const T& t, std::ostream& out) { t.write_trace(out); }) {
+                core::trace_fn = [](std::ostream& out) {
+                    assert(core::active_thread_pool && "No active thread pool set");
+                    static_cast<const T*>(core::active_thread_pool)->write_trace(out);
+                };
+            }
+
+            // Bind latency function pointer, for pools that keep histograms
+            if constexpr (requires(const T& t) { { t.latency_stats() } -> std::same_as<core::LatencyStats>; }) {
+                core::latency_fn = [] {
+                    assert(core::active_thread_pool && "No active thread pool set");
+                    return static_cast<const T*>(core::active_thread_pool)->latency_stats();
+                };
+            }
+
+            // Bind profile function pointer, for pools that time their scheduling loops
+            if constexpr (requires(const T& t) { { t.profile() } -> std::same_as<core::ProfileReport>; }) {
+                core::profile_fn = [] {
+                    assert(core::active_thread_pool && "No active thread pool set");
+                    return static_cast<const T*>(core::active_thread_pool)->profile();
+                };
+            }
+
             // Bind finalize function pointer
             core::finalize_fn = [](core::ShutdownMode mode) noexcept {
                 auto* p = static_cast<T*>(core::active_thread_pool);
@@ -100,6 +160,10 @@ namespace rts
 
                 core::active_thread_pool = nullptr;
                 core::enqueue_fn = nullptr;
+                core::stats_fn = nullptr;
+                core::trace_fn = nullptr;
+                core::latency_fn = nullptr;
+                core::profile_fn = nullptr;
                 core::finalize_fn = nullptr;
                 core::running.store(false, std::memory_order_release);
             };
@@ -149,4 +213,91 @@ namespace rts
         core::enqueue_fn(std::move(task));
     }
 
+    // ─────────────────────────────────────────────────────────────
+    // ────────────────────────  Stats API  ────────────────────────
+    // ─────────────────────────────────────────────────────────────
+
+    /**
+     * @brief Returns a snapshot of the scheduler counters of every worker, and the pool's
+     *        saturation, read while the workers keep running.
+     *
+     * Empty for pools that keep no counters. The counters stay at zero when the runtime
+     * is built with `MINIRTS_WORKER_STATS=0`.
+     */
+    inline core::RuntimeStats stats() {
+        assert(core::running.load(std::memory_order_acquire) && "stats() called on inactive runtime");
+        return core::stats_fn ? core::stats_fn() : core::RuntimeStats{};
+    }
+
+    /**
+     * @brief Returns the distributions of the delay from submission (rts::enqueue(), spawn()
+     *        or a continuation being scheduled) until a worker starts the task, and from
+     *        spawn() until its Future is ready, merged over the workers.
+     *
+     * Read while the workers keep running; covers everything since the runtime started.
+     * Empty unless the runtime is built with `MINIRTS_LATENCY_STATS=1`.
+     */
+    inline core::LatencyStats latency_stats() {
+        assert(core::running.load(std::memory_order_acquire) && "latency_stats() called on inactive runtime");
+        return core::latency_fn ? core::latency_fn() : core::LatencyStats{};
+    }
+
+    /**
+     * @brief Returns, for every worker, the time-stamp counter ticks spent so far in each
+     *        phase of its scheduling loop: popping, failed and successful steals, inbox
+     *        transfers, running tasks and idling. core::write_profile_report() prints it.
+     *
+     * Read while the workers keep running. Every phase stays at zero unless the runtime is
+     * built with `MINIRTS_PROFILE=1`.
+     */
+    inline core::ProfileReport profile() {
+        assert(core::running.load(std::memory_order_acquire) && "profile() called on inactive runtime");
+        return core::profile_fn ? core::profile_fn() : core::ProfileReport{};
+    }
+
+    // ─────────────────────────────────────────────────────────────
+    // ───────────────────────  Tracing API  ───────────────────────
+    // ─────────────────────────────────────────────────────────────
+
+    /**
+     * @brief Writes the execution timeline recorded so far as Chrome trace JSON, which
+     *        chrome://tracing and ui.perfetto.dev open.
+     *
+     * Each worker keeps its latest core::kTraceBufferEvents events: task and park spans,
+     * steals and inbox transfers. The trace has no events unless the runtime is built
+     * with `MINIRTS_TRACING=1`.
+     */
+    inline void write_trace(std::ostream& out) {
+        assert(core::running.load(std::memory_order_acquire) && "write_trace() called on inactive runtime");
+        if (core::trace_fn)
+            core::trace_fn(out);
+        else
+            core::write_chrome_trace(out, {}, core::TraceClock::now(), core::TraceClock::now());
+    }
+
+    /**
+     * @brief Sets the file the trace is written to when the runtime is finalized
+     *        (empty, the default, disables it). Only used when built with `MINIRTS_TRACING=1`.
+     */
+    inline void set_trace_file(std::string path) {
+        core::trace_file = std::move(path);
+    }
+
+    // ─────────────────────────────────────────────────────────────
+    // ───────────────────────  Metrics API  ───────────────────────
+    // ─────────────────────────────────────────────────────────────
+
+    /**
+     * @brief Sets the shared-memory segment that runtimes started afterwards publish
+     *        rts::stats() to, every `period` (empty, the default, disables it).
+     *
+     * `rts-top <pid>` attaches to `core::metrics_segment_for(pid)`, which is the usual name.
+     * The segment is removed when the runtime is finalized. POSIX only.
+     */
+    inline void set_metrics_segment(std::string name,
+                                    std::chrono::milliseconds period = core::kMetricsPeriod) {
+        core::metrics_segment = std::move(name);
+        core::metrics_period = period;
+    }
+
 }// namespace rts
@@ -0,0 +1,296 @@
+/**
+ * @file slab_allocator.h
+ * @brief Defines the per-thread slab allocator used for task callables and shared states.
+ *
+ * Every thread that allocates (each Worker, and any producer thread calling `spawn`)
+ * owns a SlabAllocator. Blocks come from 64 KiB chunks, each dedicated to one size
+ * class (16-byte steps up to 256 bytes, then half powers of two up to 2 KiB), and the
+ * chunk header records the owning allocator. Freeing a block on
+ * its owner's thread pushes it onto a plain free list; freeing it anywhere else pushes
+ * it onto the owner's lock-free remote-free list, which the owner drains when a size
+ * class runs dry. Allocation and same-thread free never touch an atomic.
+ *
+ * Allocators are recycled through a global registry when their thread exits, so blocks
+ * may safely outlive the thread (or the runtime) that allocated them. Chunks are never
+ * returned to the system.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "constants.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Size-class slab allocator owned by a single thread.
+     *
+     * `allocate()` must be called by the owning thread; `deallocate()` may be called
+     * from any thread.
+     */
+    class SlabAllocator {
+    public:
+        /// @brief Granularity and alignment of slab blocks.
+        static constexpr size_t kBlockAlignment = 16;
+
+    private:
+        static constexpr size_t kSmallSizeClasses = kMaxSmallSlabBlockSize / kBlockAlignment;
+        static constexpr size_t kSmallBits = std::bit_width(kMaxSmallSlabBlockSize);   ///< Bits of the largest small block.
+        static constexpr size_t kSizeClasses = kSmallSizeClasses + 2 * (std::bit_width(kMaxSlabBlockSize) - kSmallBits);
+
+        static_assert(std::has_single_bit(kMaxSmallSlabBlockSize) && std::has_single_bit(kMaxSlabBlockSize),
+                      "Large size classes step between powers of two");
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        /// @brief Placed at the start of every chunk; blocks follow it.
+        struct alignas(kBlockAlignment) ChunkHeader {
+            SlabAllocator* owner;
+            size_t size_class;
+        };
+
+        static constexpr size_t kChunkPayloadOffset = sizeof(ChunkHeader);
+
+        std::array<FreeBlock*, kSizeClasses> free_{};   ///< Owner-only free lists.
+        std::array<char*, kSizeClasses> bump_{};        ///< Next uncarved block of the current chunk.
+        std::array<char*, kSizeClasses> bump_end_{};    ///< End of the current chunk.
+        alignas(kCacheLine) std::atomic<FreeBlock*> remote_free_{nullptr};  ///< Blocks freed by other threads.
+
+        static size_t size_class_of(size_t size) noexcept {
+            if (size <= kMaxSmallSlabBlockSize)
+                return (size + kBlockAlignment - 1) / kBlockAlignment - 1;
+            // Two classes per power of two: 3/4 of it, then all of it.
+            const size_t p = std::bit_width(size - 1);
+            return kSmallSizeClasses + 2 * (p - kSmallBits) + (size > (size_t{3} << (p - 2)) ? 1 : 0);
+        }
+
+        static size_t block_size_of(size_t c) noexcept {
+            if (c < kSmallSizeClasses)
+                return (c + 1) * kBlockAlignment;
+            const size_t k = c - kSmallSizeClasses;
+            const size_t p = kSmallBits + k / 2;
+            return k % 2 == 0 ? size_t{3} << (p - 2) : size_t{1} << p;
+        }
+
+        static ChunkHeader* chunk_of(void* p) noexcept {
+            return reinterpret_cast<ChunkHeader*>(
+                reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(kSlabChunkSize - 1));
+        }
+
+        /// @brief Moves every remotely freed block back onto the owner's free lists.
+        bool drain_remote_frees() noexcept {
+            FreeBlock* block = remote_free_.exchange(nullptr, std::memory_order_acquire);
+            if (!block)
+                return false;
+            while (block) {
+                FreeBlock* next = block->next;
+                const size_t c = chunk_of(block)->size_class;
+                block->next = free_[c];
+                free_[c] = block;
+                block = next;
+            }
+            return true;
+        }
+
+        /// @brief Carves a block from the current chunk of class `c`, starting a new chunk if needed.
+        void* carve(size_t c) {
+            const size_t block_size = block_size_of(c);
+            if (bump_[c] == nullptr || bump_[c] + block_size > bump_end_[c]) {
+                void* mem = std::aligned_alloc(kSlabChunkSize, kSlabChunkSize);
+                if (!mem)
+                    throw std::bad_alloc();
+                auto* header = ::new (mem) ChunkHeader{this, c};
+                bump_[c] = reinterpret_cast<char*>(header) + kChunkPayloadOffset;
+                bump_end_[c] = reinterpret_cast<char*>(header) + kSlabChunkSize;
+            }
+            void* block = bump_[c];
+            bump_[c] += block_size;
+            return block;
+        }
+
+        void free_local(void* p, size_t c) noexcept {
+            auto* block = static_cast<FreeBlock*>(p);
+            block->next = free_[c];
+            free_[c] = block;
+        }
+
+        void free_remote(void* p) noexcept {
+            auto* block = static_cast<FreeBlock*>(p);
+            block->next = remote_free_.load(std::memory_order_relaxed);
+            while (!remote_free_.compare_exchange_weak(block->next, block,
+                                                       std::memory_order_release,
+                                                       std::memory_order_relaxed)) {}
+        }
+
+        /// @brief Allocators of exited threads, kept for reuse (never destroyed).
+        struct Registry {
+            std::mutex mtx;
+            std::vector<SlabAllocator*> idle;
+        };
+
+        static Registry& registry() {
+            static auto* r = new Registry;
+            return *r;
+        }
+
+        static inline thread_local SlabAllocator* tls_allocator_ = nullptr;
+        static inline thread_local bool tls_released_ = false;
+
+        /// @brief Returns the thread's allocator to the registry on thread exit.
+        struct Releaser {
+            ~Releaser() {
+                if (tls_allocator_) {
+                    std::lock_guard lk(registry().mtx);
+                    registry().idle.push_back(tls_allocator_);
+                }
+                tls_allocator_ = nullptr;
+                tls_released_ = true;
+            }
+        };
+
+        static SlabAllocator* acquire() {
+            {
+                std::lock_guard lk(registry().mtx);
+                if (!registry().idle.empty()) {
+                    SlabAllocator* a = registry().idle.back();
+                    registry().idle.pop_back();
+                    return a;
+                }
+            }
+            return new SlabAllocator;
+        }
+
+        SlabAllocator() = default;
+
+    public:
+        SlabAllocator(const SlabAllocator&) = delete;
+        SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+        /**
+         * @brief Returns the calling thread's allocator, acquiring one on first use.
+         */
+        static SlabAllocator& local() {
+            if (!tls_allocator_) [[unlikely]] {
+                tls_allocator_ = acquire();
+                if (!tls_released_) {
+                    // Allocations made while the thread is exiting keep their allocator.
+                    thread_local Releaser releaser;
+                    (void)releaser;
+                }
+            }
+            return *tls_allocator_;
+        }
+
+        /**
+         * @brief Returns true if a block of this size and alignment is served from slabs.
+         */
+        static constexpr bool fits(size_t size, size_t align) noexcept {
+            return size != 0 && size <= kMaxSlabBlockSize && align <= kBlockAlignment;
+        }
+
+        /**
+         * @brief Allocates `size` bytes. Must be called by the owning thread.
+         * @note Sizes above kMaxSlabBlockSize fall through to operator new.
+         */
+        void* allocate(size_t size) {
+            assert(this == tls_allocator_ && "SlabAllocator::allocate() called from a foreign thread");
+            if (!fits(size, kBlockAlignment))
+                return ::operator new(size);
+
+            const size_t c = size_class_of(size);
+            if (FreeBlock* block = free_[c]) [[likely]] {
+                free_[c] = block->next;
+                return block;
+            }
+            if (remote_free_.load(std::memory_order_relaxed) && drain_remote_frees() && free_[c]) {
+                FreeBlock* block = free_[c];
+                free_[c] = block->next;
+                return block;
+            }
+            return carve(c);
+        }
+
+        /**
+         * @brief Frees a block of `size` bytes allocated by any SlabAllocator. Callable from any thread.
+         */
+        static void deallocate(void* p, size_t size) noexcept {
+            if (!p)
+                return;
+            if (!fits(size, kBlockAlignment)) {
+                ::operator delete(p);
+                return;
+            }
+            ChunkHeader* chunk = chunk_of(p);
+            if (chunk->owner == tls_allocator_)
+                chunk->owner->free_local(p, chunk->size_class);
+            else
+                chunk->owner->free_remote(p);
+        }
+
+        /**
+         * @brief Allocates storage for an object of the given size and alignment on the calling thread.
+         *
+         * Blocks that do not fit a size class (or are over-aligned) use operator new.
+         */
+        static void* allocate_bytes(size_t size, size_t align) {
+            if (fits(size, align))
+                return local().allocate(size);
+            if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                return ::operator new(size, std::align_val_t{align});
+            return ::operator new(size);
+        }
+
+        /**
+         * @brief Frees storage obtained from allocate_bytes() with the same size and alignment.
+         */
+        static void deallocate_bytes(void* p, size_t size, size_t align) noexcept {
+            if (fits(size, align))
+                deallocate(p, size);
+            else if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                ::operator delete(p, std::align_val_t{align});
+            else
+                ::operator delete(p);
+        }
+    };
+
+    /**
+     * @brief Standard allocator adaptor over the calling thread's SlabAllocator.
+     *
+     * Stateless: memory allocated on one thread may be freed on any other.
+     * Used with `std::allocate_shared` and standard containers.
+     */
+    template <typename T>
+    struct SlabStdAllocator {
+        using value_type = T;
+
+        SlabStdAllocator() noexcept = default;
+
+        template <typename U>
+        SlabStdAllocator(const SlabStdAllocator<U>&) noexcept {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(SlabAllocator::allocate_bytes(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            SlabAllocator::deallocate_bytes(p, n * sizeof(T), alignof(T));
+        }
+
+        template <typename U>
+        bool operator==(const SlabStdAllocator<U>&) const noexcept { return true; }
+    };
+
+} // namespace rts::core
@@ -0,0 +1,103 @@
+/**
+ * @file stats.h
+ * @brief Scheduler counters kept by every worker, and the snapshot returned by rts::stats().
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Events counted by one worker.
+     *
+     * Every counter is written by the worker's own thread only, so it is bumped with a
+     * relaxed load and store rather than a read-modify-write, and may be read at any time
+     * by other threads. The block sits on its own cache line(s).
+     */
+    struct alignas(kCacheLine) WorkerCounters {
+        std::atomic<uint64_t> tasks_executed {0};   ///< Tasks run: popped from the WSQ, or continuations run inline.
+        std::atomic<uint64_t> local_pops {0};       ///< Tasks popped from the worker's own WSQ.
+        std::atomic<uint64_t> local_pushes {0};     ///< Tasks pushed on the worker's own WSQ.
+        std::atomic<uint64_t> inbox_transfers {0};  ///< Tasks moved from the inbox to the WSQ.
+        std::atomic<uint64_t> steal_attempts {0};
+        std::atomic<uint64_t> steal_successes {0};
+        std::atomic<uint64_t> tasks_stolen {0};     ///< Tasks taken by the successful steals.
+        std::atomic<uint64_t> idle_iterations {0};  ///< Scheduling loop iterations that found no task.
+        std::atomic<uint64_t> parks {0};            ///< Times the worker went to sleep.
+
+        /// @brief Adds `n` to a counter of the calling worker (compiled out unless kWorkerStats).
+        static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) noexcept {
+            if constexpr (kWorkerStats)
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Values of WorkerCounters at one point in time (or summed over workers), with
+     *        the depth of the worker's queues at that time.
+     */
+    struct WorkerStats {
+        uint64_t tasks_executed = 0;
+        uint64_t local_pops = 0;
+        uint64_t local_pushes = 0;
+        uint64_t inbox_transfers = 0;
+        uint64_t steal_attempts = 0;
+        uint64_t steal_successes = 0;
+        uint64_t tasks_stolen = 0;
+        uint64_t idle_iterations = 0;
+        uint64_t parks = 0;
+        uint64_t wsq_depth = 0;      ///< Tasks in the WSQ (a gauge, not a counter).
+        uint64_t inbox_depth = 0;    ///< Tasks in the inbox (a gauge, not a counter).
+
+        /// @brief Reads `counters` without stopping their worker.
+        static WorkerStats load(const WorkerCounters& counters) noexcept {
+            constexpr auto relaxed = std::memory_order_relaxed;
+            return {
+                counters.tasks_executed.load(relaxed),
+                counters.local_pops.load(relaxed),
+                counters.local_pushes.load(relaxed),
+                counters.inbox_transfers.load(relaxed),
+                counters.steal_attempts.load(relaxed),
+                counters.steal_successes.load(relaxed),
+                counters.tasks_stolen.load(relaxed),
+                counters.idle_iterations.load(relaxed),
+                counters.parks.load(relaxed),
+            };
+        }
+
+        WorkerStats& operator+=(const WorkerStats& other) noexcept {
+            tasks_executed += other.tasks_executed;
+            local_pops += other.local_pops;
+            local_pushes += other.local_pushes;
+            inbox_transfers += other.inbox_transfers;
+            steal_attempts += other.steal_attempts;
+            steal_successes += other.steal_successes;
+            tasks_stolen += other.tasks_stolen;
+            idle_iterations += other.idle_iterations;
+            parks += other.parks;
+            wsq_depth += other.wsq_depth;
+            inbox_depth += other.inbox_depth;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Snapshot of the runtime's scheduler activity.
+     *
+     * Counters are read one by one while the workers keep running, so the snapshot is
+     * not atomic as a whole; each counter is monotonic across snapshots of one runtime
+     * (the queue depths are not).
+     */
+    struct RuntimeStats {
+        std::vector<WorkerStats> workers;   ///< One entry per worker, in pool order.
+        WorkerStats total;                  ///< Sum over the workers.
+        double saturation = 0.0;            ///< Queued tasks per WSQ slot, see DefaultThreadPool::compute_saturation().
+    };
+
+} // namespace rts::core
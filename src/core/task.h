@@ -4,28 +4,58 @@
  *        used by the RTS scheduler to represent units of executable work.
  *
  * Each Task stores:
- *   - a pointer to a heap-allocated callable,
+ *   - the callable itself, inline, when it is small and trivially relocatable,
+ *     or otherwise a pointer to a copy of it in the thread's SlabAllocator,
  *   - a function pointer to invoke it,
- *   - and a function pointer to destroy it.
+ *   - a function pointer to destroy it (null when there is nothing to destroy),
+ *   - and, with kLatencyStats, the read_tsc() tick at which it was submitted.
  *
  * The design avoids std::function overhead and allows non-throwing, type-erased
- * execution in hot paths. Tasks cannot be move-only because Work-Stealing queues require copyable types.
+ * execution in hot paths. Tasks cannot be move-only because Work-Stealing queues require copyable types:
+ * queues copy Tasks bitwise, so only callables that survive being relocated with memcpy are stored inline.
  */
 
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <type_traits>
 #include <utility>
 
+#include "constants.h"
+#include "slab_allocator.h"
+#include "utils.h"
+
 namespace rts::core {
+    /**
+     * @brief Trait telling whether a callable can be moved to another address with memcpy,
+     *        leaving the source without destroying it.
+     *
+     * Defaults to std::is_trivially_copyable. Specialize it for named functors whose members
+     * are relocatable (e.g. unique ownership handles) to let Task store them inline.
+     */
+    template <typename F>
+    struct is_trivially_relocatable : std::is_trivially_copyable<F> {};
+
+    template <typename F>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<F>::value;
+
+    /// @brief Stand-in for Task::submitted_at when latency stats are compiled out: reads as 0, ignores writes.
+    struct NoSubmitTime {
+        constexpr NoSubmitTime& operator=(uint64_t) noexcept { return *this; }
+        constexpr operator uint64_t() const noexcept { return 0; }
+    };
+
     /**
      * @brief Represents a type-erased callable used by the runtime.
      *
-     * A Task is the basic executable unit within the RTS. It holds a pointer
-     * to a heap-allocated callable and the function pointers needed to
-     * invoke and destroy it safely. It is intended to be passed around
-     * thread-safe queues and executed asynchronously.
+     * A Task is the basic executable unit within the RTS. Small trivially relocatable
+     * callables (captureless lambdas, lambdas capturing references or scalars, ...)
+     * live in the Task's inline buffer; larger ones are slab-allocated. It holds
+     * the function pointers needed to invoke and destroy the callable safely, and
+     * is intended to be passed around thread-safe queues and executed asynchronously.
      */
     struct Task {
         /// @brief Function pointer type for invoking the stored callable.
@@ -34,13 +64,23 @@ namespace rts::core {
         /// @brief Function pointer type for destroying the stored callable.
         using DestroyFn = void(*)(void*) noexcept;
 
-        /// @brief Pointer to the heap-allocated callable.
-        void* callable_ptr = nullptr;
+        /// @brief Returns true if a callable of type Fn is stored inline rather than on the heap.
+        template <typename Fn>
+        static constexpr bool stores_inline =
+            is_trivially_relocatable_v<Fn>
+            && sizeof(Fn) <= kTaskInlineSize
+            && alignof(Fn) <= alignof(std::max_align_t);
 
-        /// @brief Function pointer to invoke the callable.
+        /// @brief Inline callable, or a pointer to the slab-allocated one.
+        alignas(std::max_align_t) unsigned char storage[kTaskInlineSize];
+
+        /// @brief read_tsc() tick of the last submission to a queue (see mark_submitted()).
+        [[no_unique_address]] std::conditional_t<kLatencyStats, uint64_t, NoSubmitTime> submitted_at {};
+
+        /// @brief Function pointer to invoke the callable (receives `storage`).
         InvokeFn invoke_fn = nullptr;
 
-        /// @brief Function pointer to destroy the callable.
+        /// @brief Function pointer to destroy the callable (receives `storage`), or null.
         DestroyFn destroy_fn = nullptr;
 
         /// @brief Default-constructed Task represents an empty/no-op task.
@@ -65,19 +105,41 @@ namespace rts::core {
                     std::invocable<std::decay_t<F>&>
             Task(F&& f) noexcept {
             using Fn = std::decay_t<F>;
-            callable_ptr = new Fn(std::forward<F>(f));
-
-            assert(callable_ptr && "Task allocation failed");
-            invoke_fn = [](void* p) noexcept {
-                assert(p && "Invalid function pointer in invoke()");
-                (*static_cast<Fn*>(p))();
-            };
-
-            destroy_fn = [](void* p) noexcept {
-                assert(p && "Invalid function pointer in destroy()");
-                delete static_cast<Fn*>(p);
-            };
-            assert(invoke_fn && destroy_fn && "Invalid function pointers set in Task");
+
+            if constexpr (stores_inline<Fn>) {
+                ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+
+                invoke_fn = [](void* p) noexcept {
+                    assert(p && "Invalid function pointer in invoke()");
+                    (*std::launder(static_cast<Fn*>(p)))();
+                };
+
+                if constexpr (!std::is_trivially_destructible_v<Fn>) {
+                    destroy_fn = [](void* p) noexcept {
+                        assert(p && "Invalid function pointer in destroy()");
+                        std::launder(static_cast<Fn*>(p))->~Fn();
+                    };
+                }
+            } else {
+                void* mem = SlabAllocator::allocate_bytes(sizeof(Fn), alignof(Fn));
+                assert(mem && "Task allocation failed");
+                Fn* callable = ::new (mem) Fn(std::forward<F>(f));
+                ::new (static_cast<void*>(storage)) Fn*(callable);
+
+                invoke_fn = [](void* p) noexcept {
+                    assert(p && "Invalid function pointer in invoke()");
+                    (**static_cast<Fn**>(p))();
+                };
+
+                destroy_fn = [](void* p) noexcept {
+                    assert(p && "Invalid function pointer in destroy()");
+                    Fn* callable = *static_cast<Fn**>(p);
+                    callable->~Fn();
+                    SlabAllocator::deallocate_bytes(callable, sizeof(Fn), alignof(Fn));
+                };
+                assert(destroy_fn && "Invalid function pointers set in Task");
+            }
+            assert(invoke_fn && "Invalid function pointers set in Task");
         }
 
         /**
@@ -86,29 +148,38 @@ namespace rts::core {
          */
         void operator()() const noexcept {
             assert(invoke_fn && "Task::invoke_fn is null");
-            assert(callable_ptr && "Task::callable_ptr is null");
-            invoke_fn(callable_ptr);
+            invoke_fn(const_cast<unsigned char*>(storage));
         }
 
         /**
          * @brief Destroys the stored callable and resets the task to empty.
          */
         void destroy() noexcept {
-            assert((callable_ptr && invoke_fn && destroy_fn) &&
-           "Invalid Task partial state: missing one of the members");
+            assert(invoke_fn && "Invalid Task partial state: missing invoke_fn");
 
-            destroy_fn(callable_ptr);
+            if (destroy_fn)
+                destroy_fn(storage);
 
-            callable_ptr = nullptr;
             invoke_fn = nullptr;
             destroy_fn = nullptr;
         }
 
+        /**
+         * @brief Stamps the Task with the current tick (no-op unless kLatencyStats).
+         * @note Called by the queues' producers when the Task is submitted.
+         */
+        void mark_submitted() noexcept {
+            if constexpr (kLatencyStats)
+                submitted_at = read_tsc();
+        }
+
         /**
          * @brief Returns true if the Task contains a valid callable.
          */
         explicit operator bool() const noexcept {
-            return callable_ptr && invoke_fn && destroy_fn;
+            return invoke_fn != nullptr;
         }
     };
+
+    static_assert(std::is_trivially_copyable_v<Task>, "Queues copy Tasks bitwise");
 } // namespace rts::core
\ No newline at end of file
@@ -0,0 +1,220 @@
+/**
+ * @file topology.h
+ * @brief Discovers the machine's CPU topology and groups steal victims by distance.
+ *
+ * Worker `i` is pinned to logical CPU `i`, so the topology of the CPUs tells each
+ * worker which of its peers share a physical core, a last-level cache or a NUMA node.
+ * Thieves try the closest tier first and only escalate to farther ones after
+ * repeated failures, which keeps stolen tasks (and the cache lines they touch) local.
+ *
+ * On Linux the topology is read from /sys/devices/system/cpu and /sys/devices/system/node.
+ * Elsewhere, or when sysfs is unavailable, every peer is treated as remote, which
+ * degenerates to plain random stealing.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace rts::core {
+
+    /**
+     * @brief Distance tiers between two workers, from closest to farthest.
+     *
+     * - `SMT_TIER`:    Hyper-threads of the same physical core.
+     * - `CACHE_TIER`:  Different cores sharing the last-level (L3) cache.
+     * - `NUMA_TIER`:   Same NUMA node, different last-level cache.
+     * - `REMOTE_TIER`: Another NUMA node, or unknown placement.
+     */
+    enum StealTier {
+        SMT_TIER = 0,
+        CACHE_TIER = 1,
+        NUMA_TIER = 2,
+        REMOTE_TIER = 3
+    };
+
+    /// @brief Number of StealTier values.
+    inline constexpr size_t kStealTiers = 4;
+
+    /// @brief Indices of the other workers of a pool, grouped by StealTier.
+    using VictimTiers = std::array<std::vector<uint32_t>, kStealTiers>;
+
+    /**
+     * @brief Placement of one logical CPU. Unknown fields are -1.
+     */
+    struct CpuLocation {
+        int core = -1;   ///< Lowest logical CPU among the SMT siblings.
+        int cache = -1;  ///< Lowest logical CPU sharing the last-level cache.
+        int node = -1;   ///< NUMA node.
+    };
+
+    /**
+     * @brief Parses a sysfs CPU list such as "0-3,8,10-11".
+     * @return The listed CPUs in order. Malformed entries are skipped.
+     */
+    inline std::vector<int> parse_cpu_list(std::string_view list) {
+        std::vector<int> cpus;
+        while (!list.empty()) {
+            const size_t comma = list.find(',');
+            std::string_view range = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            while (!range.empty() && (range.back() == '\n' || range.back() == ' '))
+                range.remove_suffix(1);
+
+            int first = 0;
+            int last = 0;
+            const char* end = range.data() + range.size();
+            auto [p, ec] = std::from_chars(range.data(), end, first);
+            if (ec != std::errc{})
+                continue;
+            last = first;
+            if (p != end && *p == '-') {
+                if (std::from_chars(p + 1, end, last).ec != std::errc{} || last < first)
+                    continue;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    /**
+     * @brief Placement of every logical CPU of the machine.
+     */
+    class Topology {
+        std::vector<CpuLocation> cpus_;  ///< Indexed by logical CPU.
+
+        static std::optional<std::string> read_line(const std::filesystem::path& path) {
+            std::ifstream in(path);
+            std::string line;
+            if (!in || !std::getline(in, line))
+                return std::nullopt;
+            return line;
+        }
+
+        static int lowest_cpu(const std::filesystem::path& list_path) {
+            const auto line = read_line(list_path);
+            if (!line)
+                return -1;
+            const auto cpus = parse_cpu_list(*line);
+            return cpus.empty() ? -1 : *std::min_element(cpus.begin(), cpus.end());
+        }
+
+    public:
+        /**
+         * @brief Constructs an empty topology: every CPU is treated as remote.
+         */
+        Topology() = default;
+
+        /**
+         * @brief Constructs a topology from known CPU placements.
+         */
+        explicit Topology(std::vector<CpuLocation> cpus) noexcept
+            : cpus_(std::move(cpus)) {}
+
+        /**
+         * @brief Reads the topology of the running machine from sysfs.
+         */
+        static Topology discover() {
+            namespace fs = std::filesystem;
+            std::vector<CpuLocation> cpus;
+            std::error_code ec;
+
+            const fs::path cpu_root = "/sys/devices/system/cpu";
+            for (int cpu = 0; fs::exists(cpu_root / ("cpu" + std::to_string(cpu)), ec); ++cpu) {
+                const fs::path dir = cpu_root / ("cpu" + std::to_string(cpu));
+                CpuLocation loc;
+                loc.core = lowest_cpu(dir / "topology" / "thread_siblings_list");
+
+                // The last-level cache is the highest-level cache listed for the CPU.
+                int best_level = 0;
+                for (int index = 0; fs::exists(dir / "cache" / ("index" + std::to_string(index)), ec); ++index) {
+                    const fs::path cache = dir / "cache" / ("index" + std::to_string(index));
+                    const auto level = read_line(cache / "level");
+                    const int lvl = level ? std::atoi(level->c_str()) : 0;
+                    if (lvl > best_level) {
+                        best_level = lvl;
+                        loc.cache = lowest_cpu(cache / "shared_cpu_list");
+                    }
+                }
+                cpus.push_back(loc);
+            }
+
+            const fs::path node_root = "/sys/devices/system/node";
+            for (int node = 0; fs::exists(node_root / ("node" + std::to_string(node)), ec); ++node) {
+                const auto line = read_line(node_root / ("node" + std::to_string(node)) / "cpulist");
+                if (!line)
+                    continue;
+                for (int cpu : parse_cpu_list(*line)) {
+                    if (cpu >= 0 && static_cast<size_t>(cpu) < cpus.size())
+                        cpus[static_cast<size_t>(cpu)].node = node;
+                }
+            }
+            return Topology(std::move(cpus));
+        }
+
+        /**
+         * @brief Returns the topology of the running machine, discovered once per process.
+         */
+        static const Topology& system() {
+            static const Topology topology = discover();
+            return topology;
+        }
+
+        /**
+         * @brief Returns the number of logical CPUs with a known placement.
+         */
+        [[nodiscard]] size_t cpu_count() const noexcept {
+            return cpus_.size();
+        }
+
+        /**
+         * @brief Returns the distance tier between two logical CPUs.
+         */
+        [[nodiscard]] StealTier tier_between(size_t a, size_t b) const noexcept {
+            if (a >= cpus_.size() || b >= cpus_.size())
+                return REMOTE_TIER;
+
+            const CpuLocation& la = cpus_[a];
+            const CpuLocation& lb = cpus_[b];
+            if (la.core >= 0 && la.core == lb.core)
+                return SMT_TIER;
+            if (la.cache >= 0 && la.cache == lb.cache)
+                return CACHE_TIER;
+            if (la.node >= 0 && la.node == lb.node)
+                return NUMA_TIER;
+            return REMOTE_TIER;
+        }
+
+        /**
+         * @brief Groups the other workers of a pool by their distance to `worker`.
+         *
+         * Worker `i` is assumed to run on logical CPU `i` (see `pin_to_core`).
+         * @param worker Index of the thief.
+         * @param num_workers Number of workers in the pool.
+         */
+        [[nodiscard]] VictimTiers victim_tiers(size_t worker, size_t num_workers) const {
+            VictimTiers tiers;
+            for (size_t other = 0; other < num_workers; ++other) {
+                if (other != worker)
+                    tiers[tier_between(worker, other)].push_back(static_cast<uint32_t>(other));
+            }
+            return tiers;
+        }
+    };
+
+} // namespace rts::core
@@ -0,0 +1,184 @@
+/**
+ * @file trace.h
+ * @brief Per-worker event rings for the execution timeline, and their Chrome trace export.
+ *
+ * When built with kTracing, every worker appends to its own TraceBuffer: one span per
+ * task it runs and per park, and one instant event per successful steal and inbox
+ * transfer. Timestamps are raw read_tsc() ticks; a TraceClock taken when the pool
+ * starts and another taken at export time convert them to microseconds.
+ *
+ * The export is the Chrome trace event JSON format, which chrome://tracing and
+ * ui.perfetto.dev both open.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+#include "utils.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Kinds of traced events.
+     */
+    enum class TraceKind : uint8_t {
+        TASK,       ///< Span: a task run by the scheduling loop or while helping.
+        PARK,       ///< Span: the worker slept.
+        STEAL,      ///< Instant: tasks taken from another worker (value = count).
+        TRANSFER,   ///< Instant: tasks moved from the inbox to the WSQ (value = count).
+    };
+
+    /**
+     * @brief One event read back from a TraceBuffer.
+     */
+    struct TraceRecord {
+        TraceKind kind;
+        uint64_t begin;   ///< Tick of the event (start of a span).
+        uint64_t value;   ///< Length of a span in ticks, or the count of an instant event.
+    };
+
+    /**
+     * @brief Pairs a read_tsc() tick with the steady clock, to convert ticks to time.
+     */
+    struct TraceClock {
+        uint64_t tsc;
+        std::chrono::steady_clock::time_point time;
+
+        static TraceClock now() noexcept { return {read_tsc(), std::chrono::steady_clock::now()}; }
+    };
+
+    /**
+     * @brief Ring of the latest kTraceBufferEvents events of one worker.
+     *
+     * Written by the worker's thread only, without locks or read-modify-writes, and
+     * readable at any time: an event is claimed before it is written and committed after,
+     * so a concurrent snapshot() drops the slots that were overwritten while it copied.
+     */
+    class TraceBuffer {
+        static constexpr unsigned kKindShift = 56;
+        static constexpr uint64_t kValueMask = (uint64_t{1} << kKindShift) - 1;
+
+        struct Slot {
+            std::atomic<uint64_t> begin {0};
+            std::atomic<uint64_t> kind_value {0};   ///< Kind in the top byte, value below.
+        };
+
+        std::unique_ptr<Slot[]> slots_ = std::make_unique<Slot[]>(kTraceBufferEvents);
+        alignas(kCacheLine) std::atomic<uint64_t> claimed_ {0};    ///< Events started.
+        std::atomic<uint64_t> committed_ {0};                      ///< Events fully written.
+
+    public:
+        /// @brief Appends an event. Must be called from the owning worker's thread.
+        void record(TraceKind kind, uint64_t begin, uint64_t value) noexcept {
+            const uint64_t index = claimed_.load(std::memory_order_relaxed);
+            claimed_.store(index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            Slot& slot = slots_[index & (kTraceBufferEvents - 1)];
+            slot.begin.store(begin, std::memory_order_relaxed);
+            slot.kind_value.store(static_cast<uint64_t>(kind) << kKindShift | (value & kValueMask),
+                                  std::memory_order_relaxed);
+            committed_.store(index + 1, std::memory_order_release);
+        }
+
+        /// @brief Appends a span that started at `begin` and ends now.
+        void record_span(TraceKind kind, uint64_t begin) noexcept {
+            // The length, unlike the absolute end tick, always fits below the kind byte.
+            const uint64_t end = read_tsc();
+            record(kind, begin, end > begin ? end - begin : 0);
+        }
+
+        /// @brief Appends an instant event happening now.
+        void record_instant(TraceKind kind, uint64_t count) noexcept {
+            record(kind, read_tsc(), count);
+        }
+
+        /// @brief Copies the retained events, oldest first. May run while the worker records.
+        [[nodiscard]] std::vector<TraceRecord> snapshot() const {
+            const uint64_t end = committed_.load(std::memory_order_acquire);
+            const uint64_t begin = end > kTraceBufferEvents ? end - kTraceBufferEvents : 0;
+
+            std::vector<TraceRecord> records;
+            records.reserve(static_cast<size_t>(end - begin));
+            for (uint64_t i = begin; i != end; ++i) {
+                const Slot& slot = slots_[i & (kTraceBufferEvents - 1)];
+                const uint64_t kind_value = slot.kind_value.load(std::memory_order_relaxed);
+                records.push_back({static_cast<TraceKind>(kind_value >> kKindShift),
+                                   slot.begin.load(std::memory_order_relaxed),
+                                   kind_value & kValueMask});
+            }
+
+            // Slots claimed again since `end` may have been torn while copying: drop them.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t claimed = claimed_.load(std::memory_order_relaxed);
+            const uint64_t first_intact = claimed > kTraceBufferEvents ? claimed - kTraceBufferEvents : 0;
+            if (first_intact > begin)
+                records.erase(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(
+                    std::min(first_intact - begin, end - begin)));
+            return records;
+        }
+    };
+
+    /**
+     * @brief Writes the events of every worker (`workers[i]` is worker `i`) as Chrome trace JSON.
+     *
+     * Ticks are converted to microseconds since `start` with the rate observed between
+     * `start` and `end`, written with nanosecond resolution.
+     */
+    inline void write_chrome_trace(std::ostream& out, const std::vector<std::vector<TraceRecord>>& workers,
+                                   TraceClock start, TraceClock end) {
+        const double elapsed_us = std::chrono::duration<double, std::micro>(end.time - start.time).count();
+        const double us_per_tick = end.tsc > start.tsc && elapsed_us > 0
+                                 ? elapsed_us / static_cast<double>(end.tsc - start.tsc) : 0.0;
+        auto to_us = [&](uint64_t tick) {
+            return tick > start.tsc ? static_cast<double>(tick - start.tsc) * us_per_tick : 0.0;
+        };
+
+        const std::ios_base::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"tsc_invariant\":"
+            << (is_tsc_invariant() ? "true" : "false") << "},\"traceEvents\":[";
+        const char* separator = "";
+        for (size_t worker = 0; worker < workers.size(); ++worker) {
+            out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << worker
+                << ",\"args\":{\"name\":\"worker " << worker << "\"}}";
+            separator = ",";
+            for (const TraceRecord& r : workers[worker]) {
+                out << ",{\"pid\":0,\"tid\":" << worker << ",\"ts\":" << to_us(r.begin);
+                switch (r.kind) {
+                    case TraceKind::TASK:
+                    case TraceKind::PARK:
+                        out << ",\"ph\":\"X\",\"name\":\"" << (r.kind == TraceKind::TASK ? "task" : "park")
+                            << "\",\"dur\":" << static_cast<double>(r.value) * us_per_tick
+                            << "}";
+                        break;
+                    case TraceKind::STEAL:
+                    case TraceKind::TRANSFER:
+                        out << ",\"ph\":\"i\",\"s\":\"t\",\"name\":\""
+                            << (r.kind == TraceKind::STEAL ? "steal" : "inbox transfer")
+                            << "\",\"args\":{\"tasks\":" << r.value << "}}";
+                        break;
+                }
+            }
+        }
+        out << "]}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    /// @brief File the runtime's trace is written to when it is finalized (empty: none).
+    inline std::string trace_file;
+
+} // namespace rts::core
@@ -1,13 +1,22 @@
 #pragma once
 
 
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <iostream>
 #include <limits>
 
 #include "constants.h"
 
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
   #include <immintrin.h> // _mm_pause on x86/x64
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #else
+    #include <cpuid.h>
+    #include <x86intrin.h>
+  #endif
 #endif
 
 #if defined(_WIN32)
@@ -40,6 +49,75 @@ inline void pause_hint() noexcept {
 #endif
 }
 
+/**
+ * @brief Reads the time-stamp counter, or a steady clock in nanoseconds on CPUs without one.
+ *
+ * The counter is not serializing: it may be read slightly before or after the
+ * surrounding instructions. Convert ticks to time by calibrating against a clock.
+ */
+inline uint64_t read_tsc() noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * @brief Returns true if read_tsc() ticks at a constant rate on every core (invariant TSC).
+ */
+inline bool is_tsc_invariant() noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0x80000000);
+    if (static_cast<unsigned>(info[0]) < 0x80000007u)
+        return false;
+    __cpuid(info, 0x80000007);
+    return (info[3] & (1 << 8)) != 0;  // Bit 8 of EDX means invariant TSC
+  #else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & (1 << 8)) != 0;  // Bit 8 of EDX means invariant TSC
+  #endif
+#else
+    return true;  // read_tsc() falls back to a steady clock.
+#endif
+}
+
+/**
+ * @brief Scrambles a seed into a non-zero state for xorshift64().
+ */
+inline uint64_t seed_rng(uint64_t seed) noexcept {
+    // splitmix64 finalizer
+    seed += 0x9E3779B97F4A7C15ULL;
+    seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+    seed ^= seed >> 31;
+    return seed != 0 ? seed : 1;
+}
+
+/**
+ * @brief Advances a xorshift64 generator and returns the next value.
+ * @param state Non-zero generator state.
+ */
+inline uint64_t xorshift64(uint64_t& state) noexcept {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**
+ * @brief Maps a random value uniformly onto [0, n) without a division.
+ */
+inline size_t bounded_random(uint64_t random, size_t n) noexcept {
+    return static_cast<size_t>(((random >> 32) * static_cast<uint64_t>(n)) >> 32);
+}
+
+
 #if defined(__cpp_lib_syncstream) && (__cpp_lib_syncstream >= 201803L)
 #include <syncstream>
 
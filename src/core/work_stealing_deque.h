@@ -0,0 +1,259 @@
+/**
+ * @file work_stealing_deque.h
+ * @brief Defines the Chase-Lev work-stealing deque used as each Worker's local queue.
+ *
+ * The owner pushes and pops at the bottom; thieves take from the top. On top of the
+ * classic single-element `steal()`, thieves can claim half of a victim's queue with
+ * `steal_half_from()`, which copies the batch and then commits it with a single CAS
+ * on the victim's top index.
+ *
+ * Batch steals are made safe for the owner's CAS-free pop as follows. A thief that
+ * observed top == t claims at most ceil((b - t) / 2) elements, where b is a bottom
+ * value it read while top was t. The owner tracks the highest bottom published since
+ * it last saw top change (`high_water_`), so it knows no batch can reach past
+ * t + ceil((high_water_ - t) / 2). Pops above that line need no CAS; pops below it
+ * take the oldest element with the same CAS thieves use, which also invalidates any
+ * batch still in flight.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+
+namespace rts::core {
+
+    /**
+     * @brief Unbounded lock-free work-stealing deque with bulk stealing.
+     *
+     * Only the owning thread may call `emplace()`, `pop()` and `steal_half_from()`
+     * (the latter on its own deque, passing the victim). Any thread may call `steal()`,
+     * `size()` and `empty()`.
+     *
+     * @tparam T Element type. Elements are copied in and out of the ring buffer, so T
+     *           must be copyable and trivially destructible.
+     */
+    template <typename T>
+    class WorkStealingDeque {
+        static_assert(std::is_copy_constructible_v<T>, "WorkStealingDeque elements must be copyable");
+        static_assert(std::is_trivially_destructible_v<T>, "WorkStealingDeque elements must be trivially destructible");
+
+        /// @brief Power-of-two ring buffer indexed by monotonically increasing positions.
+        struct Ring {
+            std::int64_t capacity;
+            std::int64_t mask;
+            std::unique_ptr<T[]> slots;
+
+            explicit Ring(std::int64_t cap)
+                : capacity(cap), mask(cap - 1), slots(std::make_unique<T[]>(static_cast<size_t>(cap))) {}
+
+            T& operator[](std::int64_t i) noexcept { return slots[static_cast<size_t>(i & mask)]; }
+        };
+
+        alignas(kCacheLine) std::atomic<std::int64_t> top_{0};      ///< Next element thieves take.
+        alignas(kCacheLine) std::atomic<std::int64_t> bottom_{0};   ///< Next free slot of the owner.
+        std::int64_t high_water_ = 0;   ///< Owner-only: highest bottom published since top last changed.
+        std::int64_t last_top_ = 0;     ///< Owner-only: top as of the last pop().
+        alignas(kCacheLine) std::atomic<Ring*> ring_;                ///< Current ring buffer.
+        std::vector<std::unique_ptr<Ring>> rings_;  ///< Owner-only: current and retired rings.
+
+        /**
+         * @brief Replaces the ring with one that holds at least `required` elements.
+         *
+         * Retired rings stay alive until destruction since thieves may still read them.
+         */
+        Ring* grow(Ring* ring, std::int64_t t, std::int64_t b, std::int64_t required) {
+            std::int64_t cap = ring->capacity * 2;
+            while (cap < required) cap *= 2;
+
+            auto bigger = std::make_unique<Ring>(cap);
+            for (std::int64_t i = t; i < b; ++i) {
+                (*bigger)[i] = (*ring)[i];
+            }
+            Ring* raw = bigger.get();
+            rings_.push_back(std::move(bigger));
+            ring_.store(raw, std::memory_order_relaxed);
+            return raw;
+        }
+
+        /// @brief Publishes elements written below `b` to thieves.
+        void publish_bottom(std::int64_t b) noexcept {
+            high_water_ = std::max(high_water_, b);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(b, std::memory_order_relaxed);
+        }
+
+    public:
+        /**
+         * @brief Constructs an empty deque.
+         * @param capacity Initial capacity (rounded up to a power of two). The deque grows on demand.
+         */
+        explicit WorkStealingDeque(size_t capacity = kDefaultCapacity) {
+            std::int64_t cap = 2;
+            while (cap < static_cast<std::int64_t>(capacity)) cap *= 2;
+            rings_.push_back(std::make_unique<Ring>(cap));
+            ring_.store(rings_.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        /**
+         * @brief Returns an approximation of the number of queued elements.
+         */
+        [[nodiscard]] size_t size() const noexcept {
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t t = top_.load(std::memory_order_relaxed);
+            return b > t ? static_cast<size_t>(b - t) : 0;
+        }
+
+        /**
+         * @brief Returns true if the deque appears empty.
+         */
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         * @brief Returns the capacity of the current ring buffer.
+         */
+        [[nodiscard]] size_t capacity() const noexcept {
+            return static_cast<size_t>(ring_.load(std::memory_order_relaxed)->capacity);
+        }
+
+        /**
+         * @brief Pushes an element at the bottom. Owner only.
+         */
+        template <typename... Args>
+        void emplace(Args&&... args) {
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t t = top_.load(std::memory_order_acquire);
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+
+            if (b - t >= ring->capacity) {
+                ring = grow(ring, t, b, b - t + 1);
+            }
+            (*ring)[b] = T(std::forward<Args>(args)...);
+            publish_bottom(b + 1);
+        }
+
+        /**
+         * @brief Pops the most recently pushed element. Owner only.
+         *
+         * When a batch thief could still be claiming the bottom element, the oldest
+         * element is taken instead (through the same CAS thieves use).
+         * @return The element, or std::nullopt if the deque is empty.
+         */
+        std::optional<T> pop() noexcept {
+            for (;;) {
+                const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+                Ring* ring = ring_.load(std::memory_order_relaxed);
+                bottom_.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                std::int64_t t = top_.load(std::memory_order_relaxed);
+
+                if (t > b) {
+                    // Empty.
+                    bottom_.store(b + 1, std::memory_order_relaxed);
+                    return std::nullopt;
+                }
+
+                if (t != last_top_) {
+                    // Bottom only grew since the previous pop, so b + 1 bounds what
+                    // thieves may have read since top became t.
+                    last_top_ = t;
+                    high_water_ = b + 1;
+                }
+
+                // Past the reach of any batch steal: the element is ours.
+                if (b - t >= (high_water_ - t + 1) / 2) {
+                    return (*ring)[b];
+                }
+
+                // Contended region: race thieves for the top element.
+                T x = (*ring)[t];
+                const bool won = top_.compare_exchange_strong(t, t + 1,
+                                                              std::memory_order_seq_cst,
+                                                              std::memory_order_relaxed);
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                if (won) {
+                    return x;
+                }
+                // A thief took the top; retry with the new top.
+            }
+        }
+
+        /**
+         * @brief Steals the oldest element. Callable from any thread.
+         * @return The element, or std::nullopt if the deque is empty or the race was lost.
+         */
+        std::optional<T> steal() noexcept {
+            std::int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t b = bottom_.load(std::memory_order_acquire);
+
+            if (t >= b) {
+                return std::nullopt;
+            }
+            T x = (*ring_.load(std::memory_order_acquire))[t];
+            if (!top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+            return x;
+        }
+
+        /**
+         * @brief Moves the older half (rounded up) of `victim` to the bottom of this deque.
+         *
+         * The batch is copied straight into this deque's ring, past its published bottom,
+         * and claimed with a single CAS on the victim's top. Called by this deque's owner.
+         *
+         * @param victim Deque to steal from (owned by another thread).
+         * @return Number of elements stolen (0 if the victim was empty or the race was lost).
+         */
+        size_t steal_half_from(WorkStealingDeque& victim) {
+            assert(&victim != this && "A worker cannot steal from itself");
+
+            std::int64_t vt = victim.top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t vb = victim.bottom_.load(std::memory_order_acquire);
+
+            const std::int64_t n = (vb - vt + 1) / 2;
+            if (n <= 0) {
+                return 0;
+            }
+            Ring* victim_ring = victim.ring_.load(std::memory_order_acquire);
+
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t t = top_.load(std::memory_order_acquire);
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+            if (b - t + n > ring->capacity) {
+                ring = grow(ring, t, b, b - t + n);
+            }
+            for (std::int64_t i = 0; i < n; ++i) {
+                (*ring)[b + i] = (*victim_ring)[vt + i];
+            }
+
+            if (!victim.top_.compare_exchange_strong(vt, vt + n,
+                                                     std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed)) {
+                return 0;
+            }
+            publish_bottom(b + n);
+            return static_cast<size_t>(n);
+        }
+    };
+
+} // namespace rts::core
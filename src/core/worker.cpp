@@ -1,5 +1,9 @@
 #include "worker.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
 void rts::core::Worker::run(size_t num_threads) noexcept {
     active_workers_->fetch_add(1, std::memory_order_release);
 
@@ -11,54 +15,93 @@ void rts::core::Worker::run(size_t num_threads) noexcept {
         // Disable work-stealing for single-worker pools
         bool enable_work_stealing = (num_threads >= 2);
 
+        // Spin-then-park when running out of work
+        const bool park_when_idle = (idle_mode_ == PARK_IDLE);
+
+        // Consecutive iterations without finding work (non-zero while counted as spinning)
+        size_t idle_rounds = 0;
+
         // Thread-local pointer to self (Used for enqueuing continuations locally).
         tls_worker = this;
+        allocator_ = &SlabAllocator::local();
 
-        // Pointers to facilitate stealing from other workers
+        // Pointers to facilitate stealing from and waking up other workers
         auto workers_shared = workers_vector_.lock();
         if (!workers_shared) {
             return;
         }
-        Worker* workers_begin = workers_shared->data();
-        Worker* workers_end {workers_begin + num_threads};
-        Worker* next_victim {workers_begin};
+        workers_begin_ = workers_shared->data();
+        workers_end_ = workers_begin_ + num_threads;
+
+        // Without topology information, every other worker is a remote victim.
+        if (std::all_of(victim_tiers_.begin(), victim_tiers_.end(), [](const auto& t) { return t.empty(); })) {
+            const auto self = static_cast<size_t>(this - workers_begin_);
+            for (size_t i = 0; i < num_threads; ++i) {
+                if (i != self)
+                    victim_tiers_[REMOTE_TIER].push_back(static_cast<uint32_t>(i));
+            }
+        }
+        update_steal_tier(true);
+
+        // Charges the loop's time to its phases (with kProfile).
+        PhaseTimer timer(profile_.get());
+
+        // Whether the worker has found no work since its last task: polling again is idling, not scheduling.
+        bool idle = true;
 
         while (shutdown_requested_->load(std::memory_order_relaxed) != HARD_SHUTDOWN) {
             if (wsq_->empty()) {
-                // Transfer as many items from spscq_ as possible.
-                while (!spscq_->empty() && wsq_->size() != wsq_->capacity()) {
-                    wsq_->emplace(std::move(*spscq_->front()));
-                    spscq_->pop();
-                }
+                const size_t moved = drain_inbox();
+                // Let a parked worker help with the batch.
+                if (park_when_idle && wsq_->size() >= 2)
+                    notify_sleeper();
+                timer.lap(moved != 0 ? Phase::TRANSFER : Phase::IDLE);
             }
             std::optional<Task> t = wsq_->pop();
+            timer.lap(t.has_value() ? Phase::POP : Phase::IDLE);
             if (t.has_value()) {
-                assert(t.value());
-                t.value()();
-                t.value().destroy();
-            } else if (enable_work_stealing) {
-                // If wsq_ still empty try stealing from another queue.
-                do {
-                    ++next_victim;
-                    if (next_victim == workers_end)
-                        next_victim = workers_begin;
-                } while (next_victim == this);
-
-                // Approximation of the victim's queue size
-                auto victim_queue_size = next_victim->wsq_size();
-
-                // Steal half their queue.
-                for (int i = 0; i < victim_queue_size/2; i++) {
-                auto stolen_task = next_victim->steal();
-                    if (stolen_task.has_value()) {
-                        enqueue_local(std::move(stolen_task.value()));
+                if (idle_rounds != 0) {
+                    // Work showed up while spinning.
+                    idle_counters_->spinning.fetch_sub(1, std::memory_order_relaxed);
+                    tune_spin_limit(idle_rounds);
+                    idle_rounds = 0;
+                }
+                idle = false;
+                WorkerCounters::bump(counters_->local_pops);
+                execute(t.value());
+                timer.lap(Phase::EXECUTE);
+            } else {
+                WorkerCounters::bump(counters_->idle_iterations);
+                if (enable_work_stealing) {
+                    // If wsq_ still empty, take the older half of a random victim's queue,
+                    // looking farther away only after repeated failures nearby.
+                    const bool stole = try_steal();
+                    if (park_when_idle && wsq_->size() >= 2)
+                        notify_sleeper();
+                    // Only the first failed scan after running out of work is overhead.
+                    timer.lap(stole ? Phase::STEAL : idle ? Phase::IDLE : Phase::STEAL_SCAN);
+                    idle = !stole;
+                } else {
+                    idle = true;
+                }
+                if (park_when_idle && wsq_->empty()) {
+                    if (idle_rounds == 0)
+                        idle_counters_->spinning.fetch_add(1, std::memory_order_relaxed);
+
+                    if (++idle_rounds >= spin_limit_
+                        && shutdown_requested_->load(std::memory_order_relaxed) == 0) {
+                        // Spin window exhausted: sleep until new work is submitted.
+                        idle_counters_->spinning.fetch_sub(1, std::memory_order_relaxed);
+                        idle_rounds = 0;
+                        park();
                     } else {
-                        break;
+                        pause_hint();
                     }
                 }
+                timer.lap(Phase::IDLE);
             }
             if (shutdown_requested_->load(std::memory_order_relaxed) == SOFT_SHUTDOWN
-                && wsq_->empty() && spscq_->empty()) {
+                && wsq_->empty() && inbox_->empty()) {
                 // Queues are empty and SOFT_SHUTDOWN signal received: Mark worker as inactive.
                 if (active) {
                     active = false;
@@ -69,9 +112,168 @@ void rts::core::Worker::run(size_t num_threads) noexcept {
                     break;
             }
         }
+        if (idle_rounds != 0)
+            idle_counters_->spinning.fetch_sub(1, std::memory_order_relaxed);
+
+        for (size_t tier = 0; tier < kStealTiers; ++tier) {
+            steals_per_tier[tier].fetch_add(tier_steals_[tier], std::memory_order_relaxed);
+        }
+        if constexpr (kProfile)
+            retire_profile(static_cast<size_t>(this - workers_begin_), PhaseStats::load(*profile_));
+
         debug_print() << "[Exit]: Thread " << core_affinity_ << std::endl
            << "[Exit]: Items left in WSQ: " << wsq_->size() << std::endl
-           << "[Exit]: Items left in MPMCQ: " << spscq_->size() << std::endl;
+           << "[Exit]: Items left in MPMCQ: " << inbox_->size() << std::endl;
     });
 }
 
+bool rts::core::Worker::help_once() noexcept {
+    assert(tls_worker == this && "help_once() called from a foreign thread");
+    if (wsq_->empty())
+        drain_inbox();
+
+    std::optional<Task> t = wsq_->pop();
+    if (!t.has_value() && workers_end_ - workers_begin_ >= 2 && try_steal())
+        t = wsq_->pop();
+    if (!t.has_value())
+        return false;
+
+    WorkerCounters::bump(counters_->local_pops);
+    execute(t.value());
+    return true;
+}
+
+void rts::core::Worker::execute(Task& task) noexcept {
+    WorkerCounters::bump(counters_->tasks_executed);
+    assert(task);
+    if constexpr (kTracing || kLatencyStats) {
+        const uint64_t begin = read_tsc();
+        uint64_t outer_submitted_at = 0;
+        if constexpr (kLatencyStats) {
+            // TSCs of different cores may disagree slightly: clamp at zero.
+            latency_->enqueue_to_start.record(begin > task.submitted_at ? begin - task.submitted_at : 0);
+            outer_submitted_at = std::exchange(tls_task_submitted_at, task.submitted_at);
+        }
+        task();
+        task.destroy();
+        if constexpr (kLatencyStats)
+            tls_task_submitted_at = outer_submitted_at;   // execute() nests while helping.
+        if constexpr (kTracing)
+            trace_->record_span(TraceKind::TASK, begin);
+    } else {
+        task();
+        task.destroy();
+    }
+}
+
+size_t rts::core::Worker::drain_inbox() noexcept {
+    Task incoming;
+    uint64_t moved = 0;
+    while (wsq_->size() != wsq_->capacity() && inbox_->try_pop(incoming)) {
+        wsq_->emplace(std::move(incoming));
+        ++moved;
+    }
+    if (moved != 0) {
+        WorkerCounters::bump(counters_->inbox_transfers, moved);
+        if constexpr (kTracing)
+            trace_->record_instant(TraceKind::TRANSFER, moved);
+    }
+    return moved;
+}
+
+bool rts::core::Worker::try_steal() noexcept {
+    const size_t stolen = steal_half_from(*pick_victim());
+    const bool stole = stolen != 0;
+    WorkerCounters::bump(counters_->steal_attempts);
+    if (stole) {
+        ++tier_steals_[steal_tier_];
+        WorkerCounters::bump(counters_->steal_successes);
+        WorkerCounters::bump(counters_->tasks_stolen, stolen);
+        if constexpr (kTracing)
+            trace_->record_instant(TraceKind::STEAL, stolen);
+    }
+    update_steal_tier(stole);
+    return stole;
+}
+
+bool rts::core::Worker::has_pending_work() const noexcept {
+    if (!wsq_->empty() || !inbox_->empty())
+        return true;
+
+    // Mirror the stealing policy: steal_half_from() takes even a lone task.
+    for (const Worker* w = workers_begin_; w != workers_end_; ++w) {
+        if (w != this && w->wsq_size() != 0)
+            return true;
+    }
+    return false;
+}
+
+rts::core::Worker* rts::core::Worker::pick_victim() noexcept {
+    const auto& tier = victim_tiers_[steal_tier_];
+    assert(!tier.empty() && "Stealing requires at least two workers");
+
+    return workers_begin_ + tier[bounded_random(xorshift64(rng_state_), tier.size())];
+}
+
+void rts::core::Worker::update_steal_tier(bool stole) noexcept {
+    size_t next;
+    if (stole) {
+        next = 0;
+    } else if (++steal_failures_ >= kStealAttemptsPerVictim * victim_tiers_[steal_tier_].size()) {
+        next = (steal_tier_ + 1) % kStealTiers;
+    } else {
+        return;
+    }
+    // Skip tiers without workers (e.g. no SMT sibling in the pool).
+    for (size_t i = 0; i < kStealTiers && victim_tiers_[next].empty(); ++i) {
+        next = (next + 1) % kStealTiers;
+    }
+    steal_tier_ = next;
+    steal_failures_ = 0;
+}
+
+void rts::core::Worker::park() noexcept {
+    idle_counters_->sleeping.fetch_add(1, std::memory_order_relaxed);
+    parker_->prepare_park();
+
+    // Re-check after announcing ourselves: a producer that published work before
+    // our announcement is visible here, and one that publishes after it will unpark us.
+    if (has_pending_work() || shutdown_requested_->load(std::memory_order_relaxed) != 0) {
+        parker_->cancel_park();
+    } else {
+        WorkerCounters::bump(counters_->parks);
+        const uint64_t begin = kTracing ? read_tsc() : 0;
+        parker_->park();
+        if constexpr (kTracing)
+            trace_->record_span(TraceKind::PARK, begin);
+        tune_spin_limit(0);
+    }
+    idle_counters_->sleeping.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void rts::core::Worker::tune_spin_limit(size_t idle_rounds) noexcept {
+    if (idle_rounds == 0) {
+        // Spinning did not pay off: shrink the window.
+        spin_limit_ -= spin_limit_ / 4;
+    } else {
+        // Move the window towards twice the observed gap between tasks.
+        const auto target = static_cast<std::ptrdiff_t>(2 * idle_rounds);
+        const auto current = static_cast<std::ptrdiff_t>(spin_limit_);
+        spin_limit_ = static_cast<size_t>(current + (target - current) / 8);
+    }
+    spin_limit_ = std::clamp(spin_limit_, kMinIdleSpins, kMaxIdleSpins);
+}
+
+void rts::core::Worker::notify_sleeper() const noexcept {
+    // Publish the pushed task before looking at the idle counters (pairs with Parker::prepare_park()).
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (idle_counters_->sleeping.load(std::memory_order_relaxed) == 0
+        || idle_counters_->spinning.load(std::memory_order_relaxed) != 0)
+        return;
+
+    for (const Worker* w = workers_begin_; w != workers_end_; ++w) {
+        if (w != this && w->parker_->unpark())
+            return;
+    }
+}
@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -17,11 +19,17 @@
 #include <vector>
 
 #include "constants.h"
+#include "latency.h"
+#include "mpmc_queue.h"
+#include "parker.h"
+#include "profile.h"
+#include "slab_allocator.h"
+#include "stats.h"
 #include "task.h"
+#include "topology.h"
+#include "trace.h"
 #include "utils.h"
-
-#include "rigtorp/SPSCQueue.h"
-#include "riften/deque.hpp"
+#include "work_stealing_deque.h"
 
 namespace rts::core {
 
@@ -36,14 +44,34 @@ namespace rts::core {
      */
     inline thread_local Worker* tls_worker = nullptr;
 
+    /**
+     * @brief Number of continuations currently running inline on this thread.
+     *        Bounded by kMaxInlineContinuationDepth.
+     */
+    inline thread_local size_t tls_continuation_depth = 0;
+
+    /**
+     * @brief Task::submitted_at of the task the worker is running (with kLatencyStats).
+     */
+    inline thread_local uint64_t tls_task_submitted_at = 0;
+
+    /**
+     * @brief Successful steals per StealTier, summed over every worker that has exited.
+     *
+     * Each worker counts its own steals and adds them here when its thread stops.
+     */
+    inline std::array<std::atomic<uint64_t>, kStealTiers> steals_per_tier{};
+
     /**
      * @brief Represents a single worker thread in the MiniRTS thread pool.
      *
      * Each Worker owns:
      *  - A work-stealing deque (WSQ) for enqueueing continuations locally
      *      and allowing other Workers to steal from the Worker.
-     *  - An SPSC queue (SPSCQ) for tasks submitted externally.
+     *  - An MPMC inbox for tasks submitted externally, by any number of producer threads.
      *  - A dedicated thread executing `run()`, which continually processes tasks.
+     *  - A Parker on which the thread sleeps when idle (in `PARK_IDLE` mode).
+     *  - A SlabAllocator serving the task callables and shared states it creates.
      *
      * Workers coordinate via shared atomic flags and a global vector of all workers.
      * Each worker can steal tasks from others to balance load.
@@ -51,43 +79,134 @@ namespace rts::core {
      * Thread-safe, non-copyable, and movable (to allow storage in std::vector).
      */
     class Worker {
-        using WSQ   = riften::Deque<Task>;
-        using SPSCQ = rigtorp::SPSCQueue<Task>;
+        using WSQ   = WorkStealingDeque<Task>;
+        using Inbox = MPMCQueue<Task>;
 
         std::thread thread_;                            ///< The thread executing this worker's main loop.
         std::unique_ptr<WSQ> wsq_;                      ///< Local work-stealing queue.
-        std::unique_ptr<SPSCQ> spscq_;                  ///< Single-producer, single-consumer submission queue.
+        std::unique_ptr<Inbox> inbox_;                  ///< Multi-producer submission queue.
         std::shared_ptr<std::atomic<int>> shutdown_requested_; ///< Shared shutdown flag.
         std::weak_ptr<std::vector<Worker>> workers_vector_;  ///< Shared vector of all workers (for stealing).
         std::shared_ptr<std::atomic<int>> active_workers_;     ///< Tracks number of active workers.
+        std::unique_ptr<Parker> parker_;                ///< Parking spot used when idle.
+        std::shared_ptr<IdleCounters> idle_counters_;   ///< Pool-wide spinning/sleeping counts.
+        SlabAllocator* allocator_ = nullptr;            ///< Slab allocator of the worker thread (set by run()).
+        Worker* workers_begin_ = nullptr;               ///< First worker of the pool (set by run()).
+        Worker* workers_end_ = nullptr;                 ///< One past the last worker of the pool.
+        size_t spin_limit_;                             ///< Current adaptive spin window.
+        uint64_t rng_state_;                            ///< Victim selection PRNG state.
+        VictimTiers victim_tiers_;                      ///< Other workers, grouped by distance.
+        size_t steal_tier_ = 0;                         ///< Tier currently being robbed.
+        size_t steal_failures_ = 0;                     ///< Failed steals on the current tier.
+        std::array<uint64_t, kStealTiers> tier_steals_{}; ///< Successful steals per tier, published on exit.
+        std::unique_ptr<WorkerCounters> counters_;      ///< Scheduler events, read by rts::stats().
+        std::unique_ptr<TraceBuffer> trace_;            ///< Event timeline (only allocated if kTracing).
+        std::unique_ptr<WorkerLatency> latency_;        ///< Latency histograms (only allocated if kLatencyStats).
+        std::unique_ptr<WorkerProfile> profile_;        ///< Ticks per loop phase (only allocated if kProfile).
+        IdleMode idle_mode_;                            ///< What to do when out of work.
         int core_affinity_;                             ///< Logical CPU core index for pinning.
 
+        /**
+         * @brief Runs and destroys a task popped from the WSQ, recording it when tracing.
+         */
+        void execute(Task& task) noexcept;
+
+        /**
+         * @brief Returns true if this worker could currently find something to run.
+         */
+        [[nodiscard]] bool has_pending_work() const noexcept;
+
+        /**
+         * @brief Picks a uniformly random worker of the current steal tier.
+         * @note Requires a pool of at least two workers.
+         */
+        [[nodiscard]] Worker* pick_victim() noexcept;
+
+        /**
+         * @brief Updates the steal tier after a steal attempt.
+         *
+         * A success returns the thief to its closest tier; repeated failures move it
+         * to the next non-empty tier, wrapping around after the farthest one.
+         */
+        void update_steal_tier(bool stole) noexcept;
+
+        /**
+         * @brief Steals the older half of a victim's WSQ and updates the steal tier.
+         * @return True if anything was stolen.
+         * @note Requires a pool of at least two workers.
+         */
+        bool try_steal() noexcept;
+
+        /**
+         * @brief Moves as many tasks as fit from the inbox to the WSQ.
+         * @return The number of tasks moved.
+         */
+        size_t drain_inbox() noexcept;
+
+        /**
+         * @brief Parks the calling worker thread until it is unparked.
+         *
+         * Returns immediately if work or a shutdown request became visible while preparing to park.
+         */
+        void park() noexcept;
+
+        /**
+         * @brief Adapts the spin window after an idle period.
+         * @param idle_rounds Number of idle iterations before work was found (0 if the worker parked).
+         */
+        void tune_spin_limit(size_t idle_rounds) noexcept;
+
+        /**
+         * @brief Wakes one parked worker of the pool, unless some worker is still spinning.
+         * @note The caller must have published its work before calling.
+         */
+        void notify_sleeper() const noexcept;
+
     public:
         /**
          * @brief Constructs a Worker instance with initialized queues and shared state.
          *
          * @param core_affinity   CPU core index to which the worker will be pinned.
          * @param stop_flag       Shared atomic flag used to signal shutdown.
-         * @param queue_capacity  Capacity for both WSQ and SPSC queues.
+         * @param queue_capacity  Capacity for both the WSQ and the inbox.
          * @param workers_vector  Shared vector of all workers.
          * @param active_workers  Shared atomic tracking active worker count.
+         * @param idle_counters   Shared spinning/sleeping counts of the pool.
+         * @param idle_mode       Whether the worker spins forever or parks when idle.
+         * @param victim_tiers    Other workers grouped by distance. If all tiers are empty,
+         *                        every other worker is treated as remote.
          */
         Worker(int core_affinity,
                const std::shared_ptr<std::atomic<int>>& stop_flag,
                size_t queue_capacity,
                std::shared_ptr<std::vector<Worker>> workers_vector,
-               std::shared_ptr<std::atomic<int>> active_workers) noexcept
+               std::shared_ptr<std::atomic<int>> active_workers,
+               std::shared_ptr<IdleCounters> idle_counters,
+               IdleMode idle_mode = kDefaultIdleMode,
+               VictimTiers victim_tiers = {}) noexcept
             : wsq_(std::make_unique<WSQ>(queue_capacity)),
-              spscq_(std::make_unique<SPSCQ>(queue_capacity)),
+              inbox_(std::make_unique<Inbox>(queue_capacity)),
               shutdown_requested_(stop_flag),
               workers_vector_(std::move(workers_vector)),
               active_workers_(std::move(active_workers)),
+              parker_(std::make_unique<Parker>()),
+              idle_counters_(std::move(idle_counters)),
+              spin_limit_(kInitialIdleSpins),
+              rng_state_(seed_rng(static_cast<uint64_t>(core_affinity))),
+              victim_tiers_(std::move(victim_tiers)),
+              counters_(std::make_unique<WorkerCounters>()),
+              trace_(kTracing ? std::make_unique<TraceBuffer>() : nullptr),
+              latency_(kLatencyStats ? std::make_unique<WorkerLatency>() : nullptr),
+              profile_(kProfile ? std::make_unique<WorkerProfile>() : nullptr),
+              idle_mode_(idle_mode),
               core_affinity_(core_affinity) {
             assert(wsq_ && "Failed to allocate WSQ");
-            assert(spscq_ && "Failed to allocate SPSCQ");
+            assert(inbox_ && "Failed to allocate inbox");
             assert(shutdown_requested_ && "Shutdown flag must not be null");
             assert(!workers_vector_.expired() && "workers_vector_ must not be null");
             assert(active_workers_ && "active_workers_ must not be null");
+            assert(parker_ && "Failed to allocate Parker");
+            assert(idle_counters_ && "idle_counters_ must not be null");
         }
 
         /**
@@ -112,6 +231,83 @@ namespace rts::core {
             return wsq_->size();
         }
 
+        /**
+         * @brief Returns the approximate number of tasks waiting in the inbox.
+         */
+        [[nodiscard]] size_t inbox_size() const noexcept {
+            assert(inbox_ && "Inbox not initialized");
+            return inbox_->size();
+        }
+
+        /**
+         * @brief Returns the position of this worker in its pool, in `[0, pool_size())`.
+         * @note Only valid once the worker is running.
+         */
+        [[nodiscard]] size_t index() const noexcept {
+            assert(workers_begin_ && "Worker index queried before run()");
+            return static_cast<size_t>(this - workers_begin_);
+        }
+
+        /**
+         * @brief Returns the number of workers in this worker's pool.
+         * @note Only valid once the worker is running.
+         */
+        [[nodiscard]] size_t pool_size() const noexcept {
+            assert(workers_begin_ && "Pool size queried before run()");
+            return static_cast<size_t>(workers_end_ - workers_begin_);
+        }
+
+        /**
+         * @brief Returns the slab allocator of this worker's thread.
+         * @note Only valid once the worker is running; allocate only from the worker's own thread.
+         */
+        [[nodiscard]] SlabAllocator& allocator() const noexcept {
+            assert(allocator_ && "Worker allocator not initialized");
+            return *allocator_;
+        }
+
+        /**
+         * @brief Returns the scheduler counters of this worker.
+         * @note Only the worker's own thread may bump them; any thread may read them.
+         */
+        [[nodiscard]] WorkerCounters& counters() const noexcept {
+            assert(counters_ && "Worker counters not initialized");
+            return *counters_;
+        }
+
+        /**
+         * @brief Returns the event timeline of this worker, or nullptr when not built with kTracing.
+         */
+        [[nodiscard]] const TraceBuffer* trace() const noexcept {
+            return trace_.get();
+        }
+
+        /**
+         * @brief Returns the latency histograms of this worker, or nullptr when not built with kLatencyStats.
+         * @note Only the worker's own thread may record into them; any thread may read them.
+         */
+        [[nodiscard]] WorkerLatency* latency() const noexcept {
+            return latency_.get();
+        }
+
+        /**
+         * @brief Returns the loop phase timings of this worker, or nullptr when not built with kProfile.
+         * @note Only the worker's own thread may record into them; any thread may read them.
+         */
+        [[nodiscard]] const WorkerProfile* profile() const noexcept {
+            return profile_.get();
+        }
+
+        /**
+         * @brief Moves the older half of `victim`'s WSQ to this worker's WSQ.
+         * @return Number of tasks stolen.
+         * @note Must be called from this worker's thread.
+         */
+        size_t steal_half_from(Worker& victim) noexcept {
+            assert(wsq_ && victim.wsq_ && "Work-stealing queue not initialized");
+            return wsq_->steal_half_from(*victim.wsq_);
+        }
+
         /**
          * @brief Attempts to steal a task from this worker’s WSQ.
          * @return An optional Task if stealing succeeded, otherwise std::nullopt.
@@ -133,6 +329,24 @@ namespace rts::core {
          */
         void run(size_t num_threads = 1) noexcept;
 
+        /**
+         * @brief Runs one task from the WSQ, the inbox or another worker's WSQ.
+         *
+         * Used by blocking calls (e.g. Future::wait()) to keep the worker busy while waiting.
+         * @return False if no task was found.
+         * @note Must be called from this worker's thread while it is running.
+         */
+        bool help_once() noexcept;
+
+        /**
+         * @brief Wakes the worker thread if it is parked.
+         * @note The caller must have published its work (or shutdown request) beforehand.
+         */
+        void unpark() const noexcept {
+            assert(parker_ && "Parker not initialized");
+            parker_->unpark();
+        }
+
         /**
          * @brief Joins the worker thread, blocking until it finishes execution.
          */
@@ -146,15 +360,38 @@ namespace rts::core {
         // ─────────────────────────────────────────────────────────────
 
         /**
-         * @brief Enqueues a task into this worker’s SPSC queue.
+         * @brief Attempts to enqueue a task into this worker’s inbox.
+         *
+         * @param task Task to enqueue, already stamped with Task::mark_submitted().
+         *             Left untouched if the inbox is full.
+         * @return False if the inbox is full.
+         * @note May be called by any number of producer threads concurrently.
+         *       Wakes this worker if it is parked.
+         */
+        bool try_enqueue(Task&& task) const noexcept {
+            assert(task && "Attempting to enqueue an empty Task");
+            assert(inbox_ && "Inbox not initialized");
+            if (!inbox_->try_emplace(std::move(task)))
+                return false;
+
+            if (idle_mode_ == PARK_IDLE) {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                parker_->unpark();
+            }
+            return true;
+        }
+
+        /**
+         * @brief Enqueues a task into this worker’s inbox, spinning while it is full.
          *
          * @param task Task to enqueue.
-         * @note Called by the submission (producer) thread. Thread-safe.
+         * @note May be called by any number of producer threads concurrently.
          */
         void enqueue(Task&& task) const noexcept {
-            assert(task && "Attempting to enqueue an empty Task");
-            assert(spscq_ && "SPSC queue not initialized");
-            spscq_->emplace(std::move(task));
+            task.mark_submitted();
+            while (!try_enqueue(std::move(task))) {
+                pause_hint();
+            }
         }
 
         /**
@@ -163,12 +400,35 @@ namespace rts::core {
          * @param task Task to enqueue.
          * @return True if the task was successfully enqueued.
          * @note Used internally by worker threads (e.g., for continuations).
+         *       Once the WSQ holds stealable work, wakes one parked worker if nobody is spinning.
          */
         void enqueue_local(Task&& task) const noexcept {
             assert(task && "Attempting to enqueue an empty Task");
             assert(wsq_ && "Work-stealing queue not initialized");
+            task.mark_submitted();
             wsq_->emplace(std::move(task));
+            WorkerCounters::bump(counters_->local_pushes);
+
+            if (idle_mode_ == PARK_IDLE && wsq_->size() >= 2) {
+                notify_sleeper();
+            }
         }
     };
 
+    /**
+     * @brief Records, on the calling worker, the time since the running task was submitted
+     *        as the latency from spawn() until its Future is ready.
+     *
+     * Compiled out unless kLatencyStats; ignored off workers.
+     */
+    inline void record_spawn_to_ready() noexcept {
+        if constexpr (kLatencyStats) {
+            if (tls_worker) {
+                const uint64_t now = read_tsc();
+                tls_worker->latency()->spawn_to_ready.record(
+                    now > tls_task_submitted_at ? now - tls_task_submitted_at : 0);
+            }
+        }
+    }
+
 } // namespace core
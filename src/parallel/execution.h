@@ -0,0 +1,281 @@
+/**
+ * @file execution.h
+ * @brief Parallel overloads of standard algorithms that run on the MiniRTS workers.
+ *
+ * `rts::for_each(rts::execution::par, first, last, f)` and friends mirror the parallel
+ * overloads of `<algorithm>` and `<numeric>`, but schedule their work with
+ * parallel_for_chunks(), parallel::reduce_chunks(), parallel::BlockedScan and
+ * parallel_sort() instead of the standard library's (TBB) backend, so a process has a
+ * single scheduler. The iterators must be random access.
+ *
+ * As with `std::execution::par`, element access functions may run concurrently and in any
+ * order, and the reduction operations must be associative and commutative. Called from
+ * outside the runtime, an algorithm blocks the caller; called from a worker, it helps
+ * with other tasks while waiting.
+ */
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "parallel_for.h"
+#include "parallel_reduce.h"
+#include "parallel_scan.h"
+#include "parallel_sort.h"
+#include "spawn.h"
+#include "worker.h"
+
+namespace rts::execution {
+
+    /**
+     * @brief Execution policy running an algorithm on the MiniRTS workers.
+     */
+    struct parallel_policy {
+        explicit parallel_policy() = default;
+    };
+
+    inline constexpr parallel_policy par {};
+
+} // namespace rts::execution
+
+namespace rts {
+
+    /**
+     * @brief Parallel std::for_each: calls `f(*it)` for every iterator in `[first, last)`.
+     */
+    template <std::random_access_iterator It, typename F>
+    void for_each(execution::parallel_policy, It first, It last, F f) {
+        parallel_for_chunks(std::ptrdiff_t{0}, static_cast<std::ptrdiff_t>(last - first),
+            [first, &f](std::ptrdiff_t b, std::ptrdiff_t e) {
+                for (It it = first + b; it != first + e; ++it)
+                    f(*it);
+            });
+    }
+
+    /**
+     * @brief Parallel std::for_each_n: calls `f` on the `n` elements starting at `first`.
+     */
+    template <std::random_access_iterator It, std::integral Size, typename F>
+    It for_each_n(execution::parallel_policy policy, It first, Size n, F f) {
+        if (n <= 0)
+            return first;
+        const It last = first + static_cast<std::iter_difference_t<It>>(n);
+        rts::for_each(policy, first, last, std::move(f));
+        return last;
+    }
+
+    /**
+     * @brief Parallel std::fill.
+     */
+    template <std::random_access_iterator It, typename T>
+    void fill(execution::parallel_policy policy, It first, It last, const T& value) {
+        rts::for_each(policy, first, last, [&value](auto& element) { element = value; });
+    }
+
+    /**
+     * @brief Parallel unary std::transform: `*(d_first + i) = op(*(first + i))`.
+     * @return Iterator past the last element written.
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename UnaryOp>
+    Out transform(execution::parallel_policy, In first, In last, Out d_first, UnaryOp op) {
+        const auto size = static_cast<std::ptrdiff_t>(last - first);
+        parallel_for_chunks(std::ptrdiff_t{0}, size, [first, d_first, &op](std::ptrdiff_t b, std::ptrdiff_t e) {
+            Out out = d_first + b;
+            for (In it = first + b; it != first + e; ++it, ++out)
+                *out = op(*it);
+        });
+        return d_first + size;
+    }
+
+    /**
+     * @brief Parallel binary std::transform: `*(d_first + i) = op(*(first1 + i), *(first2 + i))`.
+     * @return Iterator past the last element written.
+     */
+    template <std::random_access_iterator In1, std::random_access_iterator In2,
+              std::random_access_iterator Out, typename BinaryOp>
+    Out transform(execution::parallel_policy, In1 first1, In1 last1, In2 first2, Out d_first, BinaryOp op) {
+        const auto size = static_cast<std::ptrdiff_t>(last1 - first1);
+        parallel_for_chunks(std::ptrdiff_t{0}, size, [=, &op](std::ptrdiff_t b, std::ptrdiff_t e) {
+            for (std::ptrdiff_t i = b; i != e; ++i)
+                d_first[i] = op(first1[i], first2[i]);
+        });
+        return d_first + size;
+    }
+
+    /**
+     * @brief Parallel std::transform_reduce over one range: `init` op-combined with every
+     *        `transform(element)`.
+     *
+     * Unlike parallel_transform_reduce(), no identity element is needed: each chunk starts
+     * from its own first element, and `init` is combined exactly once.
+     */
+    template <std::random_access_iterator It, typename T, typename Reduce, typename Transform>
+    T transform_reduce(execution::parallel_policy, It first, It last, T init, Reduce reduce, Transform transform) {
+        if (!core::tls_worker) {
+            // Partial results are gathered per worker.
+            return async::spawn([&] {
+                return rts::transform_reduce(execution::par, first, last, std::move(init), reduce, transform);
+            }).get();
+        }
+
+        auto fold = [first, &reduce, &transform](size_t b, size_t e) -> std::optional<T> {
+            const It chunk = first + static_cast<std::ptrdiff_t>(b);
+            // The sequential algorithm is free to reassociate (and unrolls accordingly).
+            return std::transform_reduce(chunk + 1, first + static_cast<std::ptrdiff_t>(e),
+                                         T(transform(*chunk)), reduce, transform);
+        };
+        auto combine = [&reduce](std::optional<T> a, std::optional<T> b) -> std::optional<T> {
+            if (!a)
+                return b;
+            if (!b)
+                return a;
+            return reduce(std::move(*a), std::move(*b));
+        };
+
+        std::optional<T> partial = parallel::reduce_chunks(static_cast<size_t>(last - first),
+                                                           std::optional<T>{}, fold, combine, 0);
+        return partial ? reduce(std::move(init), std::move(*partial)) : init;
+    }
+
+    /**
+     * @brief Parallel std::transform_reduce over two ranges (e.g. an inner product).
+     */
+    template <std::random_access_iterator It1, std::random_access_iterator It2,
+              typename T, typename Reduce, typename Transform>
+    T transform_reduce(execution::parallel_policy policy, It1 first1, It1 last1, It2 first2,
+                       T init, Reduce reduce, Transform transform) {
+        // Iterate over indices so the two ranges advance together.
+        const auto index = std::views::iota(std::ptrdiff_t{0}, static_cast<std::ptrdiff_t>(last1 - first1));
+        return rts::transform_reduce(policy, index.begin(), index.end(), std::move(init), reduce,
+            [first1, first2, &transform](std::ptrdiff_t i) { return transform(first1[i], first2[i]); });
+    }
+
+    /**
+     * @brief Parallel inner product: `init + sum(*(first1 + i) * *(first2 + i))`.
+     */
+    template <std::random_access_iterator It1, std::random_access_iterator It2, typename T>
+    T transform_reduce(execution::parallel_policy policy, It1 first1, It1 last1, It2 first2, T init) {
+        return rts::transform_reduce(policy, first1, last1, first2, std::move(init),
+                                     std::plus<>{}, std::multiplies<>{});
+    }
+
+    /**
+     * @brief Parallel std::reduce with a binary operation.
+     */
+    template <std::random_access_iterator It, typename T, typename BinaryOp>
+    T reduce(execution::parallel_policy policy, It first, It last, T init, BinaryOp op) {
+        return rts::transform_reduce(policy, first, last, std::move(init), op, std::identity{});
+    }
+
+    /**
+     * @brief Parallel std::reduce with `std::plus<>`.
+     */
+    template <std::random_access_iterator It, typename T>
+    T reduce(execution::parallel_policy policy, It first, It last, T init) {
+        return rts::reduce(policy, first, last, std::move(init), std::plus<>{});
+    }
+
+    /**
+     * @brief Parallel std::reduce of the elements' value type, starting from a value-initialized sum.
+     */
+    template <std::random_access_iterator It>
+    std::iter_value_t<It> reduce(execution::parallel_policy policy, It first, It last) {
+        return rts::reduce(policy, first, last, std::iter_value_t<It>{});
+    }
+
+    /**
+     * @brief Parallel std::count_if.
+     */
+    template <std::random_access_iterator It, typename Pred>
+    std::iter_difference_t<It> count_if(execution::parallel_policy policy, It first, It last, Pred pred) {
+        return rts::transform_reduce(policy, first, last, std::iter_difference_t<It>{0}, std::plus<>{},
+            [&pred](const auto& element) -> std::iter_difference_t<It> { return pred(element) ? 1 : 0; });
+    }
+
+    /**
+     * @brief Parallel std::sort, see parallel_sort().
+     */
+    template <std::random_access_iterator It, typename Comp = std::less<>>
+    requires std::sortable<It, Comp>
+    void sort(execution::parallel_policy, It first, It last, Comp comp = {}) {
+        rts::parallel_sort(first, last, std::move(comp));
+    }
+
+    /**
+     * @brief Parallel std::stable_sort, see parallel_stable_sort().
+     */
+    template <std::random_access_iterator It, typename Comp = std::less<>>
+    requires std::sortable<It, Comp>
+    void stable_sort(execution::parallel_policy, It first, It last, Comp comp = {}) {
+        rts::parallel_stable_sort(first, last, std::move(comp));
+    }
+
+    /**
+     * @brief Parallel std::merge, see parallel_merge().
+     */
+    template <std::random_access_iterator It1, std::random_access_iterator It2,
+              std::random_access_iterator Out, typename Comp = std::less<>>
+    requires std::mergeable<It1, It2, Out, Comp>
+    Out merge(execution::parallel_policy, It1 first1, It1 last1, It2 first2, It2 last2, Out out, Comp comp = {}) {
+        return rts::parallel_merge(first1, last1, first2, last2, out, std::move(comp));
+    }
+
+    /**
+     * @brief Parallel std::inclusive_scan, see parallel_inclusive_scan().
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename Op = std::plus<>>
+    Out inclusive_scan(execution::parallel_policy, In first, In last, Out out, Op op = {}) {
+        return rts::parallel_inclusive_scan(first, last, out, std::move(op));
+    }
+
+    /**
+     * @brief Parallel std::inclusive_scan starting from `init`.
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename Op, typename T>
+    Out inclusive_scan(execution::parallel_policy, In first, In last, Out out, Op op, T init) {
+        return rts::parallel_inclusive_scan(first, last, out, std::move(op), std::move(init));
+    }
+
+    /**
+     * @brief Parallel std::exclusive_scan, see parallel_exclusive_scan().
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename T, typename Op = std::plus<>>
+    Out exclusive_scan(execution::parallel_policy, In first, In last, Out out, T init, Op op = {}) {
+        return rts::parallel_exclusive_scan(first, last, out, std::move(init), std::move(op));
+    }
+
+    /**
+     * @brief Parallel std::copy_if, see parallel_copy_if().
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename Pred>
+    Out copy_if(execution::parallel_policy, In first, In last, Out out, Pred pred) {
+        return rts::parallel_copy_if(first, last, out, std::move(pred));
+    }
+
+    /**
+     * @brief Parallel std::partition; the order within both groups is kept, see parallel_partition().
+     */
+    template <std::random_access_iterator It, typename Pred>
+    requires std::permutable<It>
+    It partition(execution::parallel_policy, It first, It last, Pred pred) {
+        return rts::parallel_partition(first, last, std::move(pred));
+    }
+
+    /**
+     * @brief Parallel std::stable_partition, see parallel_partition().
+     */
+    template <std::random_access_iterator It, typename Pred>
+    requires std::permutable<It>
+    It stable_partition(execution::parallel_policy, It first, It last, Pred pred) {
+        return rts::parallel_partition(first, last, std::move(pred));
+    }
+
+} // namespace rts
@@ -0,0 +1,159 @@
+/**
+ * @file parallel_for.h
+ * @brief Provides `parallel_for()`, a loop split across workers by lazy binary splitting.
+ *
+ * A loop is started as a single range on the calling worker (or on the runtime when
+ * called from another thread). The worker running a range peels off `grain` iterations
+ * at a time, and only splits the remainder when its own WSQ is empty: the upper half is
+ * pushed where idle workers can steal it, the lower half is kept. Ranges are therefore
+ * split about as often as there are thieves to take them, not as often as the loop is
+ * long, and a loop on a busy (or single-worker) pool costs a handful of tasks.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "constants.h"
+#include "future.h"
+#include "promise.h"
+#include "runtime.h"
+#include "task.h"
+#include "worker.h"
+
+namespace rts::parallel {
+
+    /**
+     * @brief Returns the grain used when none is given: the range split in at most
+     *        kMaxParallelForChunks chunks.
+     */
+    inline size_t default_grain(size_t size) noexcept {
+        return std::max<size_t>(1, size / core::kMaxParallelForChunks);
+    }
+
+    /**
+     * @brief State shared by the tasks running one parallel loop.
+     *
+     * Lives on the stack of the caller, which waits for `done` before returning. The
+     * iterations left are counted down once per task (not per chunk); the task that
+     * reaches zero fulfills `done`, after which no task touches the job.
+     *
+     * @tparam I    Index type.
+     * @tparam Body Callable invoked as `body(chunk_begin, chunk_end)`.
+     */
+    template <std::integral I, typename Body>
+    struct ForJob {
+        Body& body;
+        size_t grain;
+        std::atomic<size_t> remaining;          ///< Iterations not yet run (or skipped).
+        std::atomic<bool> failed {false};
+        std::exception_ptr error;               ///< First exception thrown by `body`.
+        async::Promise<void> done;
+
+        ForJob(Body& b, size_t g, size_t size)
+            : body(b), grain(g), remaining(size) {}
+
+        /**
+         * @brief Runs `[begin, end)` on the calling worker, splitting it lazily.
+         */
+        void run(I begin, I end) noexcept {
+            core::Worker* worker = core::tls_worker;
+            assert(worker && "parallel_for ranges run on workers");
+            const I first = begin;
+
+            try {
+                while (begin != end && !failed.load(std::memory_order_relaxed)) {
+                    // Nothing left here for a thief to take: give it the upper half.
+                    while (static_cast<size_t>(end - begin) > grain && worker->wsq_size() == 0) {
+                        const I mid = begin + static_cast<I>(static_cast<size_t>(end - begin) / 2);
+                        worker->enqueue_local(core::Task([this, mid, end] { run(mid, end); }));
+                        end = mid;
+                    }
+                    const I chunk_end = begin + static_cast<I>(std::min(grain, static_cast<size_t>(end - begin)));
+                    body(begin, chunk_end);
+                    begin = chunk_end;
+                }
+            } catch (...) {
+                if (!failed.exchange(true, std::memory_order_acq_rel))
+                    error = std::current_exception();
+            }
+            // This task owns [first, end): the iterations it ran plus those it skipped after a failure.
+            finish(static_cast<size_t>(end - first));
+        }
+
+    private:
+        /// @brief Counts `count` iterations as done; the last one fulfills `done`.
+        void finish(size_t count) noexcept {
+            if (remaining.fetch_sub(count, std::memory_order_acq_rel) != count)
+                return;
+            // Nobody else touches the job now; the caller may destroy it once `done` is ready.
+            async::Promise<void> p = std::move(done);
+            if (failed.load(std::memory_order_relaxed))
+                p.set_exception(std::move(error));
+            else
+                p.set_value();
+        }
+    };
+
+} // namespace rts::parallel
+
+namespace rts {
+
+    /**
+     * @brief Runs `body(chunk_begin, chunk_end)` over disjoint chunks covering `[begin, end)`,
+     *        in parallel on the runtime's workers, and returns once every chunk has run.
+     *
+     * Chunks hold at most `grain` iterations. On a worker, the loop starts on the calling
+     * worker, which helps with other tasks while waiting; from any other thread, it is
+     * submitted with rts::enqueue() and the caller blocks.
+     *
+     * @param grain Maximum chunk size, and the smallest range worth splitting (0 = automatic).
+     * @throws The first exception thrown by `body`; the chunks not yet started are skipped.
+     */
+    template <std::integral I, typename Body>
+    requires std::invocable<Body&, I, I>
+    void parallel_for_chunks(I begin, I end, Body&& body, size_t grain = 0) {
+        assert(core::running.load(std::memory_order_acquire) && "parallel_for() called on inactive runtime");
+        if (!(begin < end))
+            return;
+
+        const auto size = static_cast<size_t>(end - begin);
+        parallel::ForJob<I, std::remove_reference_t<Body>> job(
+            body, grain != 0 ? grain : parallel::default_grain(size), size);
+        async::Future<void> done = job.done.get_future();
+
+        if (core::tls_worker)
+            job.run(begin, end);
+        else
+            rts::enqueue(core::Task([&job, begin, end] { job.run(begin, end); }));
+        done.get();
+    }
+
+    /**
+     * @brief Runs `body(i)` for every `i` in `[begin, end)` in parallel on the runtime's workers.
+     *
+     * Ranges are split lazily (only when the running worker's WSQ is empty), so the number
+     * of tasks adapts to how many workers are idle rather than to the length of the loop.
+     *
+     * @param grain Iterations run between two split checks, and the smallest range worth
+     *              splitting (0 = automatic). Raise it for very cheap bodies.
+     * @throws The first exception thrown by `body`.
+     */
+    template <std::integral I, typename Body>
+    requires std::invocable<Body&, I>
+    void parallel_for(I begin, I end, Body&& body, size_t grain = 0) {
+        parallel_for_chunks(begin, end, [&body](I chunk_begin, I chunk_end) {
+            for (I i = chunk_begin; i != chunk_end; ++i)
+                body(i);
+        }, grain);
+    }
+
+} // namespace rts
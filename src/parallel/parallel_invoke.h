@@ -0,0 +1,86 @@
+/**
+ * @file parallel_invoke.h
+ * @brief Provides `parallel_invoke()`, a fork-join of two callables on the runtime.
+ *
+ * The second callable is pushed on the calling worker's WSQ, where an idle worker may
+ * steal it, and the first one runs inline. The caller then helps until the second one
+ * is done, which usually means popping it back and running it itself. Nothing is
+ * allocated: the pushed Task only holds a pointer to a join record on the caller's stack.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#include "spawn.h"
+#include "task.h"
+#include "utils.h"
+#include "worker.h"
+
+namespace rts::parallel {
+
+    /**
+     * @brief Join record of the callable forked by parallel_invoke().
+     *
+     * `done` is set last: the caller may destroy the record as soon as it reads it.
+     */
+    template <typename G>
+    struct InvokeJob {
+        G& g;
+        std::exception_ptr error {};
+        std::atomic<bool> done {false};
+
+        void run() noexcept {
+            try {
+                g();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            done.store(true, std::memory_order_release);
+        }
+    };
+
+} // namespace rts::parallel
+
+namespace rts {
+
+    /**
+     * @brief Runs `f()` and `g()`, possibly in parallel, and returns once both are done.
+     *
+     * Called from outside the runtime, both run on the workers and the caller blocks.
+     *
+     * @throws The exception thrown by `f`, else the one thrown by `g` (after both completed).
+     */
+    template <typename F, typename G>
+    void parallel_invoke(F&& f, G&& g) {
+        core::Worker* worker = core::tls_worker;
+        if (!worker) {
+            async::spawn([&f, &g] { parallel_invoke(f, g); }).get();
+            return;
+        }
+
+        parallel::InvokeJob<std::remove_reference_t<G>> job {g};
+        worker->enqueue_local(core::Task([&job] { job.run(); }));
+
+        std::exception_ptr error;
+        try {
+            f();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // `g` refers to this frame: wait for it even if `f` threw.
+        while (!job.done.load(std::memory_order_acquire)) {
+            if (!worker->help_once())
+                pause_hint();
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+        if (job.error)
+            std::rethrow_exception(job.error);
+    }
+
+} // namespace rts
@@ -0,0 +1,125 @@
+/**
+ * @file parallel_reduce.h
+ * @brief Provides `parallel_reduce()` and `parallel_transform_reduce()` over random-access ranges.
+ *
+ * Chunks are scheduled like parallel_for() chunks. Each chunk folds its elements into a
+ * local accumulator, then merges it into the slot of the worker running it: one
+ * cache-line-padded slot per worker, indexed by `tls_worker->index()`. The slots are
+ * combined once, when every chunk has run. No Future or shared state is created per chunk.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+#include "parallel_for.h"
+#include "spawn.h"
+#include "worker.h"
+
+namespace rts::parallel {
+
+    /**
+     * @brief Accumulator of one worker, alone on its cache line(s).
+     */
+    template <typename T>
+    struct alignas(core::kCacheLine) WorkerSlot {
+        T value;
+    };
+
+    /**
+     * @brief Reduces `[0, size)` chunk by chunk: `fold(chunk_begin, chunk_end)` returns the
+     *        result of a chunk, which is merged into the running worker's slot with `combine`.
+     *
+     * Returns `combine` of `identity` and every slot. Must be called from a worker.
+     */
+    template <typename T, typename Fold, typename Combine>
+    T reduce_chunks(size_t size, T identity, Fold& fold, Combine& combine, size_t grain) {
+        core::Worker* worker = core::tls_worker;
+        assert(worker && "reduce_chunks() must run on a worker");
+
+        std::vector<WorkerSlot<T>> slots(worker->pool_size(), WorkerSlot<T>{identity});
+        parallel_for_chunks(size_t{0}, size, [&](size_t chunk_begin, size_t chunk_end) {
+            T acc = fold(chunk_begin, chunk_end);
+            // Merge after folding: `fold` may wait on the runtime and run another chunk here.
+            T& slot = slots[core::tls_worker->index()].value;
+            slot = combine(std::move(slot), std::move(acc));
+        }, grain);
+
+        T result = std::move(identity);
+        for (auto& slot : slots)
+            result = combine(std::move(result), std::move(slot.value));
+        return result;
+    }
+
+} // namespace rts::parallel
+
+namespace rts {
+
+    /**
+     * @brief Reduces a random-access range in parallel on the runtime's workers.
+     *
+     * Each chunk computes `acc = op(std::move(acc), element)` starting from `identity`, and
+     * chunk results are merged with `combine(T, T)`. Chunks run in no particular order, so
+     * `op` and `combine` must be associative and commutative (as with `std::reduce`), and
+     * `identity` must be neutral for `combine`.
+     *
+     * Called from outside the runtime, the reduction runs on a worker and the caller blocks.
+     *
+     * @param grain Maximum chunk size (0 = automatic), see parallel_for_chunks().
+     * @throws The first exception thrown by `op` or `combine`.
+     */
+    template <std::ranges::random_access_range R, typename T, typename Op, typename Combine>
+    requires std::ranges::sized_range<R>
+          && std::invocable<Op&, T, std::ranges::range_reference_t<R>>
+          && std::invocable<Combine&, T, T>
+    T parallel_reduce(R&& range, T identity, Op op, Combine combine, size_t grain = 0) {
+        if (!core::tls_worker) {
+            // The slots are sized and indexed from a worker.
+            return async::spawn([&] {
+                return parallel_reduce(range, identity, op, combine, grain);
+            }).get();
+        }
+
+        const auto first = std::ranges::begin(range);
+        auto fold = [&](size_t chunk_begin, size_t chunk_end) {
+            T acc = identity;
+            for (auto it = first + static_cast<std::ptrdiff_t>(chunk_begin);
+                 it != first + static_cast<std::ptrdiff_t>(chunk_end); ++it) {
+                acc = op(std::move(acc), *it);
+            }
+            return acc;
+        };
+        // `fold` keeps reading `identity`: pass a copy.
+        return parallel::reduce_chunks(static_cast<size_t>(std::ranges::size(range)),
+                                       T(identity), fold, combine, grain);
+    }
+
+    /**
+     * @brief Reduces `transform(element)` over a random-access range in parallel.
+     *
+     * Equivalent to `std::transform_reduce(first, last, identity, reduce, transform)`:
+     * `reduce` must be associative and commutative, and `identity` neutral for it.
+     */
+    template <std::ranges::random_access_range R, typename T, typename Reduce, typename Transform>
+    requires std::ranges::sized_range<R>
+          && std::invocable<Transform&, std::ranges::range_reference_t<R>>
+          && std::invocable<Reduce&, T, std::invoke_result_t<Transform&, std::ranges::range_reference_t<R>>>
+    T parallel_transform_reduce(R&& range, T identity, Reduce reduce, Transform transform, size_t grain = 0) {
+        return parallel_reduce(std::forward<R>(range), std::move(identity),
+            [&reduce, &transform](T acc, std::ranges::range_reference_t<R> element) {
+                return reduce(std::move(acc), transform(element));
+            },
+            [&reduce](T a, T b) { return reduce(std::move(a), std::move(b)); },
+            grain);
+    }
+
+} // namespace rts
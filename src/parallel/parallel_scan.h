@@ -0,0 +1,311 @@
+/**
+ * @file parallel_scan.h
+ * @brief Provides parallel prefix sums, `parallel_copy_if()` and `parallel_partition()`.
+ *
+ * All of them use the two-pass blocked scheme of parallel::BlockedScan. The range is cut
+ * in a few blocks per worker. The first pass reduces every block in parallel (a sum, or a
+ * count of the selected elements), the block results are prefix-combined sequentially,
+ * and the second pass scans (or scatters) every block in parallel from its prefix. Each
+ * element is read twice, and nothing is allocated per block beyond one prefix slot.
+ *
+ * Sums of arithmetic types with `std::plus` are folded with std::reduce in the first pass,
+ * which the compiler unrolls and vectorizes; the selection counts are branch-free for the
+ * same reason. As with `std::inclusive_scan`, the operation must be associative (not
+ * necessarily commutative), and floating-point sums may round differently from a
+ * sequential scan.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+#include "parallel_for.h"
+#include "spawn.h"
+#include "worker.h"
+
+namespace rts::parallel {
+
+    /**
+     * @brief True when `op` sums arithmetic values, so a block can be folded out of order
+     *        (and vectorized) with std::reduce.
+     */
+    template <typename T, typename Op>
+    inline constexpr bool is_vectorizable_sum_v =
+        std::is_arithmetic_v<T> && (std::same_as<Op, std::plus<>> || std::same_as<Op, std::plus<T>>);
+
+    /**
+     * @brief Folds `[first, last)` into `init`, in order unless is_vectorizable_sum_v.
+     */
+    template <typename T, typename It, typename Op>
+    T fold_block(It first, It last, T init, Op& op) {
+        if constexpr (is_vectorizable_sum_v<T, Op>)
+            return std::reduce(first, last, init, op);
+        else
+            return std::accumulate(first, last, std::move(init), op);
+    }
+
+    /**
+     * @brief Counts the elements of `[first, last)` satisfying `pred`, without branching on it.
+     */
+    template <typename It, typename Pred>
+    size_t count_block(It first, It last, Pred& pred) {
+        size_t count = 0;
+        for (; first != last; ++first)
+            count += static_cast<size_t>(static_cast<bool>(pred(*first)));
+        return count;
+    }
+
+    /**
+     * @brief The two passes of a blocked scan over `[0, size)`.
+     *
+     * reduce() summarizes the blocks in parallel and prefix-combines the summaries;
+     * scan() then visits the blocks in parallel with the combination of everything before
+     * each of them. A single block is visited on the calling thread.
+     *
+     * @tparam T Type of the block summaries.
+     */
+    template <typename T>
+    class BlockedScan {
+    public:
+        /// @brief Lays out the blocks: one block off the runtime, else a few per worker.
+        explicit BlockedScan(size_t size)
+            : size_(size),
+              blocks_(std::clamp<size_t>(size / core::kMinScanBlock, 1,
+                                         core::tls_worker ? core::tls_worker->pool_size() * core::kScanBlocksPerWorker : 1)),
+              prefix_(blocks_ + 1) {}
+
+        /// @brief Returns the first index of block `b` (`size` for `b == blocks()`).
+        [[nodiscard]] size_t bound(size_t b) const noexcept {
+            return size_ / blocks_ * b + std::min(b, size_ % blocks_);
+        }
+
+        [[nodiscard]] size_t blocks() const noexcept { return blocks_; }
+
+        /**
+         * @brief First pass: `summarize(begin, end)` returns the summary of a block, and
+         *        `combine(before, block)` appends one to a prefix.
+         *
+         * @param init Prefix of the first block (none for an inclusive scan without init).
+         * @return The combination of `init` and every block.
+         */
+        template <typename Summarize, typename Combine>
+        const std::optional<T>& reduce(std::optional<T> init, Summarize& summarize, Combine& combine) {
+            for_each_block([&](size_t b) { prefix_[b + 1].emplace(summarize(bound(b), bound(b + 1))); });
+
+            // prefix_[b] becomes `init` combined with the blocks [0, b).
+            prefix_[0] = std::move(init);
+            for (size_t b = 1; b <= blocks_; ++b) {
+                if (prefix_[b - 1])
+                    prefix_[b] = combine(*prefix_[b - 1], std::move(*prefix_[b]));
+            }
+            return prefix_[blocks_];
+        }
+
+        /**
+         * @brief Second pass: calls `visit(begin, end, prefix)` for every block, where
+         *        `prefix` is the std::optional<T> combining everything before the block.
+         */
+        template <typename Visit>
+        void scan(Visit& visit) const {
+            for_each_block([&](size_t b) { visit(bound(b), bound(b + 1), prefix_[b]); });
+        }
+
+    private:
+        template <typename F>
+        void for_each_block(F&& f) const {
+            if (blocks_ == 1) {
+                f(size_t{0});
+                return;
+            }
+            parallel_for_chunks(size_t{0}, blocks_, [&f](size_t first_block, size_t last_block) {
+                for (size_t b = first_block; b != last_block; ++b)
+                    f(b);
+            }, 1);
+        }
+
+        size_t size_;
+        size_t blocks_;
+        std::vector<std::optional<T>> prefix_;
+    };
+
+    /**
+     * @brief Shared implementation of the inclusive and exclusive parallel scans.
+     */
+    template <bool Inclusive, typename T, typename In, typename Out, typename Op>
+    Out scan(In first, In last, Out out, Op& op, std::optional<T> init) {
+        const auto size = static_cast<size_t>(last - first);
+        if (size <= core::kMinScanBlock) {
+            if constexpr (Inclusive)
+                return init ? std::inclusive_scan(first, last, out, op, std::move(*init))
+                            : std::inclusive_scan(first, last, out, op);
+            else
+                return std::exclusive_scan(first, last, out, std::move(*init), op);
+        }
+        if (!core::tls_worker) {
+            // The blocks are laid out per worker.
+            return async::spawn([&] { return scan<Inclusive>(first, last, out, op, std::move(init)); }).get();
+        }
+
+        auto summarize = [first, &op](size_t b, size_t e) -> T {
+            return fold_block(first + static_cast<std::ptrdiff_t>(b + 1), first + static_cast<std::ptrdiff_t>(e),
+                              T(first[static_cast<std::ptrdiff_t>(b)]), op);
+        };
+        auto combine = [&op](const T& before, T block) -> T { return op(before, std::move(block)); };
+        auto visit = [first, out, &op](size_t b, size_t e, const std::optional<T>& prefix) {
+            const In block_first = first + static_cast<std::ptrdiff_t>(b);
+            const In block_last  = first + static_cast<std::ptrdiff_t>(e);
+            const Out block_out  = out + static_cast<std::ptrdiff_t>(b);
+            if constexpr (Inclusive) {
+                if (prefix)
+                    std::inclusive_scan(block_first, block_last, block_out, op, *prefix);
+                else
+                    std::inclusive_scan(block_first, block_last, block_out, op);
+            } else {
+                std::exclusive_scan(block_first, block_last, block_out, *prefix, op);
+            }
+        };
+
+        BlockedScan<T> blocks(size);
+        blocks.reduce(std::move(init), summarize, combine);
+        blocks.scan(visit);
+        return out + static_cast<std::ptrdiff_t>(size);
+    }
+
+} // namespace rts::parallel
+
+namespace rts {
+
+    /**
+     * @brief Parallel std::inclusive_scan: `*(out + i)` is the `op`-combination of the
+     *        elements `[first, first + i]`. `out` may be `first`.
+     *
+     * Ranges of at most kMinScanBlock elements are scanned sequentially on the caller.
+     * Called from outside the runtime with more input, the scan runs on a worker and the
+     * caller blocks.
+     *
+     * @return Iterator past the last element written.
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename Op = std::plus<>>
+    Out parallel_inclusive_scan(In first, In last, Out out, Op op = {}) {
+        return parallel::scan<true>(first, last, out, op, std::optional<std::iter_value_t<In>>{});
+    }
+
+    /**
+     * @brief Parallel std::inclusive_scan starting from `init`.
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename Op, typename T>
+    Out parallel_inclusive_scan(In first, In last, Out out, Op op, T init) {
+        return parallel::scan<true>(first, last, out, op, std::optional<T>(std::move(init)));
+    }
+
+    /**
+     * @brief Parallel std::exclusive_scan: `*(out + i)` is `init` combined with the elements
+     *        `[first, first + i)`. `out` may be `first`.
+     *
+     * @return Iterator past the last element written.
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename T, typename Op = std::plus<>>
+    Out parallel_exclusive_scan(In first, In last, Out out, T init, Op op = {}) {
+        return parallel::scan<false>(first, last, out, op, std::optional<T>(std::move(init)));
+    }
+
+    /**
+     * @brief Parallel std::copy_if (stream compaction): copies the elements satisfying
+     *        `pred` to `out`, in order. `pred` is called twice per element.
+     *
+     * @return Iterator past the last element written.
+     */
+    template <std::random_access_iterator In, std::random_access_iterator Out, typename Pred>
+    Out parallel_copy_if(In first, In last, Out out, Pred pred) {
+        const auto size = static_cast<size_t>(last - first);
+        if (size <= core::kMinScanBlock)
+            return std::copy_if(first, last, out, pred);
+        if (!core::tls_worker)
+            return async::spawn([&] { return parallel_copy_if(first, last, out, pred); }).get();
+
+        auto count = [first, &pred](size_t b, size_t e) {
+            return parallel::count_block(first + static_cast<std::ptrdiff_t>(b), first + static_cast<std::ptrdiff_t>(e), pred);
+        };
+        auto combine = [](size_t before, size_t block) { return before + block; };
+        auto copy = [first, out, &pred](size_t b, size_t e, const std::optional<size_t>& selected_before) {
+            std::copy_if(first + static_cast<std::ptrdiff_t>(b), first + static_cast<std::ptrdiff_t>(e),
+                         out + static_cast<std::ptrdiff_t>(*selected_before), pred);
+        };
+
+        parallel::BlockedScan<size_t> blocks(size);
+        const size_t selected = *blocks.reduce(size_t{0}, count, combine);
+        blocks.scan(copy);
+        return out + static_cast<std::ptrdiff_t>(selected);
+    }
+
+    /**
+     * @brief Parallel stable partition: moves the elements satisfying `pred` before the
+     *        others, keeping the relative order within both groups. `pred` is called twice
+     *        per element.
+     *
+     * The elements are scattered to a scratch buffer of the range's size, then moved back.
+     *
+     * @return Iterator to the first element of the second group.
+     */
+    template <std::random_access_iterator It, typename Pred>
+    requires std::permutable<It>
+    It parallel_partition(It first, It last, Pred pred) {
+        using T = std::iter_value_t<It>;
+        const auto size = static_cast<size_t>(last - first);
+        if (size <= core::kMinScanBlock)
+            return std::stable_partition(first, last, pred);
+        if (!core::tls_worker)
+            return async::spawn([&] { return parallel_partition(first, last, pred); }).get();
+
+        auto count = [first, &pred](size_t b, size_t e) {
+            return parallel::count_block(first + static_cast<std::ptrdiff_t>(b), first + static_cast<std::ptrdiff_t>(e), pred);
+        };
+        auto combine = [](size_t before, size_t block) { return before + block; };
+        parallel::BlockedScan<size_t> blocks(size);
+        const size_t selected = *blocks.reduce(size_t{0}, count, combine);
+
+        auto partition_through = [&](auto buffer) {
+            // A block's selected elements follow those of the earlier blocks, and so do the others.
+            auto scatter = [&](size_t b, size_t e, const std::optional<size_t>& selected_before) {
+                size_t in = *selected_before;
+                size_t out = selected + (b - *selected_before);
+                for (size_t i = b; i != e; ++i) {
+                    auto&& element = first[static_cast<std::ptrdiff_t>(i)];
+                    const bool is_selected = static_cast<bool>(pred(element));
+                    // Select the destination rather than branch on `pred`.
+                    buffer[is_selected ? in : out] = std::move(element);
+                    in += is_selected;
+                    out += !is_selected;
+                }
+            };
+            blocks.scan(scatter);
+            parallel_for_chunks(size_t{0}, size, [&](size_t b, size_t e) {
+                std::move(buffer + static_cast<std::ptrdiff_t>(b), buffer + static_cast<std::ptrdiff_t>(e),
+                          first + static_cast<std::ptrdiff_t>(b));
+            });
+        };
+        if constexpr (std::default_initializable<T>) {
+            auto buffer = std::make_unique_for_overwrite<T[]>(size);
+            partition_through(buffer.get());
+        } else {
+            static_assert(std::copy_constructible<T>,
+                          "parallel_partition() needs default-initializable or copyable elements");
+            std::vector<T> buffer(first, last);
+            partition_through(buffer.begin());
+        }
+        return first + static_cast<std::ptrdiff_t>(selected);
+    }
+
+} // namespace rts
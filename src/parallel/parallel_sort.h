@@ -0,0 +1,190 @@
+/**
+ * @file parallel_sort.h
+ * @brief Provides `parallel_sort()`, `parallel_stable_sort()` and `parallel_merge()`.
+ *
+ * The sort is a merge sort whose two halves are forked with parallel_invoke(), down to
+ * kParallelSortCutoff elements which are sorted sequentially. Runs are merged by
+ * parallel_merge(): the middle element of the longer run is binary-searched in the other
+ * one, and the two halves of the output are merged in parallel, down to
+ * kParallelMergeCutoff elements. The merges move elements back and forth between the
+ * range and one buffer of the same size, allocated once per sort.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+#include "parallel_invoke.h"
+#include "spawn.h"
+#include "worker.h"
+
+namespace rts::parallel {
+
+    /**
+     * @brief Merges the sorted runs `[first1, last1)` and `[first2, last2)` into `out`,
+     *        splitting the merge in parallel. Stable: on ties, the first run comes first.
+     *
+     * @tparam Move Whether the elements are moved (rather than copied) to `out`.
+     */
+    template <bool Move, typename It1, typename It2, typename Out, typename Comp>
+    void merge_runs(It1 first1, It1 last1, It2 first2, It2 last2, Out out, Comp& comp) {
+        const auto n1 = last1 - first1;
+        const auto n2 = last2 - first2;
+        if (static_cast<size_t>(n1 + n2) <= core::kParallelMergeCutoff) {
+            if constexpr (Move)
+                std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+                           std::make_move_iterator(first2), std::make_move_iterator(last2), out, comp);
+            else
+                std::merge(first1, last1, first2, last2, out, comp);
+            return;
+        }
+
+        // Split the longer run in its middle; elements equal to the pivot stay on the
+        // side that keeps the first run ahead of the second.
+        It1 mid1;
+        It2 mid2;
+        if (n1 >= n2) {
+            mid1 = first1 + n1 / 2;
+            mid2 = std::lower_bound(first2, last2, *mid1, comp);
+        } else {
+            mid2 = first2 + n2 / 2;
+            mid1 = std::upper_bound(first1, last1, *mid2, comp);
+        }
+        const Out mid_out = out + (mid1 - first1) + (mid2 - first2);
+
+        rts::parallel_invoke(
+            [&] { merge_runs<Move>(first1, mid1, first2, mid2, out, comp); },
+            [&] { merge_runs<Move>(mid1, last1, mid2, last2, mid_out, comp); });
+    }
+
+    /**
+     * @brief Sorts `[first, last)`, leaving the result in the range or, if `into_buffer`,
+     *        in the buffer starting at `buffer` (which must hold as many elements).
+     *
+     * The halves are sorted into the other array, then merged into the target one.
+     *
+     * @tparam Stable Whether the sequential leaves use std::stable_sort (else std::sort).
+     */
+    template <bool Stable, typename It, typename Buf, typename Comp>
+    void sort_runs(It first, It last, Buf buffer, bool into_buffer, Comp& comp) {
+        const auto n = last - first;
+        if (static_cast<size_t>(n) <= core::kParallelSortCutoff) {
+            if constexpr (Stable)
+                std::stable_sort(first, last, comp);
+            else
+                std::sort(first, last, comp);
+            if (into_buffer)
+                std::move(first, last, buffer);
+            return;
+        }
+
+        const It mid = first + n / 2;
+        const Buf buffer_mid = buffer + n / 2;
+        rts::parallel_invoke(
+            [&] { sort_runs<Stable>(first, mid, buffer, !into_buffer, comp); },
+            [&] { sort_runs<Stable>(mid, last, buffer_mid, !into_buffer, comp); });
+
+        if (into_buffer)
+            merge_runs<true>(first, mid, mid, last, buffer, comp);
+        else
+            merge_runs<true>(buffer, buffer_mid, buffer_mid, buffer + n, first, comp);
+    }
+
+    /**
+     * @brief Sorts `[first, last)` with a scratch buffer of the same size.
+     *
+     * Default-initializable elements get an uninitialized-for-overwrite buffer; others
+     * are copied into it. Must be called from a worker.
+     */
+    template <bool Stable, typename It, typename Comp>
+    void sort(It first, It last, Comp& comp) {
+        using T = std::iter_value_t<It>;
+        assert(core::tls_worker && "parallel::sort() must run on a worker");
+        const auto n = static_cast<size_t>(last - first);
+
+        if constexpr (std::default_initializable<T>) {
+            auto buffer = std::make_unique_for_overwrite<T[]>(n);
+            sort_runs<Stable>(first, last, buffer.get(), false, comp);
+        } else {
+            static_assert(std::copy_constructible<T>,
+                          "parallel_sort() needs default-initializable or copyable elements");
+            std::vector<T> buffer(first, last);
+            sort_runs<Stable>(first, last, buffer.begin(), false, comp);
+        }
+    }
+
+} // namespace rts::parallel
+
+namespace rts {
+
+    /**
+     * @brief Sorts `[first, last)` in parallel on the runtime's workers, like std::sort.
+     *
+     * Ranges of at most kParallelSortCutoff elements are sorted in place on the caller.
+     * Larger ones need a temporary buffer of `last - first` elements. Called from
+     * outside the runtime, the sort runs on a worker and the caller blocks.
+     *
+     * @throws The first exception thrown by `comp` or by moving an element; the range is
+     *         then left in an unspecified order.
+     */
+    template <std::random_access_iterator It, typename Comp = std::less<>>
+    requires std::sortable<It, Comp>
+    void parallel_sort(It first, It last, Comp comp = {}) {
+        if (static_cast<size_t>(last - first) <= core::kParallelSortCutoff) {
+            std::sort(first, last, comp);
+            return;
+        }
+        if (!core::tls_worker) {
+            async::spawn([&] { parallel::sort<false>(first, last, comp); }).get();
+            return;
+        }
+        parallel::sort<false>(first, last, comp);
+    }
+
+    /**
+     * @brief Stable version of parallel_sort(): equivalent elements keep their order.
+     */
+    template <std::random_access_iterator It, typename Comp = std::less<>>
+    requires std::sortable<It, Comp>
+    void parallel_stable_sort(It first, It last, Comp comp = {}) {
+        if (static_cast<size_t>(last - first) <= core::kParallelSortCutoff) {
+            std::stable_sort(first, last, comp);
+            return;
+        }
+        if (!core::tls_worker) {
+            async::spawn([&] { parallel::sort<true>(first, last, comp); }).get();
+            return;
+        }
+        parallel::sort<true>(first, last, comp);
+    }
+
+    /**
+     * @brief Merges the sorted runs `[first1, last1)` and `[first2, last2)` into `out` in
+     *        parallel, like std::merge (stable, and `out` must not overlap the inputs).
+     *
+     * @return Iterator past the last element written.
+     */
+    template <std::random_access_iterator It1, std::random_access_iterator It2,
+              std::random_access_iterator Out, typename Comp = std::less<>>
+    requires std::mergeable<It1, It2, Out, Comp>
+    Out parallel_merge(It1 first1, It1 last1, It2 first2, It2 last2, Out out, Comp comp = {}) {
+        const Out out_end = out + (last1 - first1) + (last2 - first2);
+        if (!core::tls_worker && static_cast<size_t>(out_end - out) > core::kParallelMergeCutoff) {
+            async::spawn([&] { parallel::merge_runs<false>(first1, last1, first2, last2, out, comp); }).get();
+            return out_end;
+        }
+        parallel::merge_runs<false>(first1, last1, first2, last2, out, comp);
+        return out_end;
+    }
+
+} // namespace rts
@@ -0,0 +1,265 @@
+/**
+ * @file task_graph.h
+ * @brief Provides `rts::graph::Graph`, a task DAG declared once and run many times.
+ *
+ * Nodes and edges are declared up front, Taskflow-style:
+ *
+ *     rts::graph::Graph g;
+ *     auto a = g.emplace([] { ... });
+ *     auto b = g.emplace([] { ... });
+ *     auto c = g.emplace([] { ... });
+ *     a.precede(b, c);
+ *     g.run().get();
+ *
+ * The first run after a change computes the roots and sizes the dependency counters.
+ * Every run then only resets one integer counter per node and pushes the roots. A node
+ * that completes decrements the counters of its successors, pushes the ones that became
+ * ready on its worker's WSQ, and keeps the last one to run next on the same worker. The
+ * node tasks fit in a Task's inline buffer, and the Future of a run comes from the slab,
+ * so steady-state runs do not allocate.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "future.h"
+#include "promise.h"
+#include "runtime.h"
+#include "task.h"
+#include "worker.h"
+
+namespace rts::graph {
+
+    class Graph;
+
+    /**
+     * @brief Handle to a node of a Graph, used to declare its edges.
+     */
+    class Node {
+    public:
+        /// @brief Makes every node of `others` wait for this one.
+        template <std::same_as<Node>... Nodes>
+        Node& precede(Nodes... others);
+
+        /// @brief Makes this node wait for every node of `others`.
+        template <std::same_as<Node>... Nodes>
+        Node& succeed(Nodes... others);
+
+        [[nodiscard]] uint32_t index() const noexcept { return index_; }
+
+    private:
+        friend class Graph;
+
+        Node(Graph* graph, uint32_t index) noexcept : graph_(graph), index_(index) {}
+
+        Graph* graph_;
+        uint32_t index_;
+    };
+
+    /**
+     * @brief A dependency graph of tasks that can be run repeatedly.
+     *
+     * The graph must not be modified while it runs, and must outlive its runs. One run
+     * at a time: wait for the Future returned by run() before starting the next one.
+     */
+    class Graph {
+    public:
+        Graph() = default;
+        Graph(const Graph&) = delete;
+        Graph& operator=(const Graph&) = delete;
+
+        /**
+         * @brief Adds a node running `f()` once per run, after all its predecessors.
+         */
+        template <typename F>
+        requires std::invocable<std::decay_t<F>&>
+        Node emplace(F&& f) {
+            assert(!running_.load(std::memory_order_relaxed) && "Graph modified while running");
+            nodes_.push_back(NodeData{std::forward<F>(f), {}, 0});
+            prepared_ = false;
+            return Node(this, static_cast<uint32_t>(nodes_.size() - 1));
+        }
+
+        /**
+         * @brief Makes `after` wait for `before`.
+         */
+        void precede(Node before, Node after) {
+            assert(before.graph_ == this && after.graph_ == this && "Node of another Graph");
+            assert(!running_.load(std::memory_order_relaxed) && "Graph modified while running");
+            nodes_[before.index_].successors.push_back(after.index_);
+            ++nodes_[after.index_].predecessors;
+            prepared_ = false;
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return nodes_.size(); }
+
+        /**
+         * @brief Runs every node once, each after its predecessors.
+         *
+         * From a worker, the roots are pushed on its WSQ; from any other thread, they are
+         * submitted with rts::enqueue().
+         *
+         * @return A Future fulfilled once every node has run. If a node throws, the nodes
+         *         not yet started are skipped and the Future holds the first exception.
+         *         If the edges form a cycle, no node runs and the Future holds std::logic_error.
+         */
+        async::Future<void> run() {
+            assert(core::running.load(std::memory_order_acquire) && "Graph::run() called on inactive runtime");
+            [[maybe_unused]] const bool was_running = running_.exchange(true, std::memory_order_relaxed);
+            assert(!was_running && "Graph::run() called while the previous run is in progress");
+
+            if (!prepared_)
+                prepare();
+
+            done_ = async::Promise<void>();
+            async::Future<void> done = done_.get_future();
+            if (cyclic_) {
+                running_.store(false, std::memory_order_relaxed);
+                done_.set_exception(std::make_exception_ptr(std::logic_error("Graph has a cycle")));
+                return done;
+            }
+            if (nodes_.empty()) {
+                running_.store(false, std::memory_order_relaxed);
+                done_.set_value();
+                return done;
+            }
+
+            for (size_t i = 0; i < nodes_.size(); ++i)
+                pending_[i].store(nodes_[i].predecessors, std::memory_order_relaxed);
+            remaining_.store(nodes_.size(), std::memory_order_relaxed);
+            failed_.store(false, std::memory_order_relaxed);
+            error_ = nullptr;
+
+            // Pushing the roots publishes the reset counters.
+            for (const uint32_t root : roots_) {
+                core::Task task([this, root] { execute(root); });
+                if (core::tls_worker)
+                    core::tls_worker->enqueue_local(std::move(task));
+                else
+                    rts::enqueue(std::move(task));
+            }
+            return done;
+        }
+
+    private:
+        static constexpr uint32_t kNoNode = UINT32_MAX;
+
+        struct NodeData {
+            std::move_only_function<void()> work;
+            std::vector<uint32_t> successors;
+            uint32_t predecessors;
+        };
+
+        /// @brief Collects the roots, sizes the counters and checks for cycles after the graph changed.
+        void prepare() {
+            roots_.clear();
+            for (uint32_t i = 0; i < nodes_.size(); ++i) {
+                if (nodes_[i].predecessors == 0)
+                    roots_.push_back(i);
+            }
+            pending_ = std::make_unique<std::atomic<uint32_t>[]>(nodes_.size());
+            cyclic_ = !is_acyclic();
+            prepared_ = true;
+        }
+
+        /// @brief Returns true if every node is reachable in topological order (Kahn's algorithm).
+        [[nodiscard]] bool is_acyclic() const {
+            std::vector<uint32_t> indegree(nodes_.size());
+            for (size_t i = 0; i < nodes_.size(); ++i)
+                indegree[i] = nodes_[i].predecessors;
+            std::vector<uint32_t> ready = roots_;
+            size_t visited = 0;
+            while (!ready.empty()) {
+                const uint32_t i = ready.back();
+                ready.pop_back();
+                ++visited;
+                for (const uint32_t s : nodes_[i].successors) {
+                    if (--indegree[s] == 0)
+                        ready.push_back(s);
+                }
+            }
+            return visited == nodes_.size();
+        }
+
+        /**
+         * @brief Runs node `index`, then the chain of successors it made ready last.
+         */
+        void execute(uint32_t index) noexcept {
+            core::Worker* worker = core::tls_worker;
+            assert(worker && "Graph nodes run on workers");
+
+            while (index != kNoNode) {
+                NodeData& node = nodes_[index];
+                if (!failed_.load(std::memory_order_relaxed)) {
+                    try {
+                        node.work();
+                    } catch (...) {
+                        if (!failed_.exchange(true, std::memory_order_acq_rel))
+                            error_ = std::current_exception();
+                    }
+                }
+
+                uint32_t next = kNoNode;
+                for (const uint32_t s : node.successors) {
+                    if (pending_[s].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                        continue;
+                    if (next != kNoNode)
+                        worker->enqueue_local(core::Task([this, next] { execute(next); }));
+                    next = s;
+                }
+                // A ready successor keeps the run alive: only the last node can complete it.
+                if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    finish();
+                index = next;
+            }
+        }
+
+        /// @brief Fulfills the Future of the run; the graph may be reused or destroyed after.
+        void finish() noexcept {
+            async::Promise<void> done = std::move(done_);
+            std::exception_ptr error = std::move(error_);
+            running_.store(false, std::memory_order_release);
+            if (error)
+                done.set_exception(std::move(error));
+            else
+                done.set_value();
+        }
+
+        std::vector<NodeData> nodes_;
+        std::vector<uint32_t> roots_;
+        std::unique_ptr<std::atomic<uint32_t>[]> pending_;   ///< Predecessors left, per node.
+        bool prepared_ = false;
+        bool cyclic_ = false;                  ///< Set by prepare(): the graph cannot run.
+
+        std::atomic<size_t> remaining_ {0};    ///< Nodes of the current run not yet completed.
+        std::atomic<bool> running_ {false};
+        std::atomic<bool> failed_ {false};
+        std::exception_ptr error_;             ///< First exception thrown by a node.
+        async::Promise<void> done_;
+    };
+
+    template <std::same_as<Node>... Nodes>
+    Node& Node::precede(Nodes... others) {
+        (graph_->precede(*this, others), ...);
+        return *this;
+    }
+
+    template <std::same_as<Node>... Nodes>
+    Node& Node::succeed(Nodes... others) {
+        (graph_->precede(others, *this), ...);
+        return *this;
+    }
+
+} // namespace rts::graph
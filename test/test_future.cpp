@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
 #include "api.h"
 #include "utils.h"
 
@@ -129,3 +133,81 @@ TEST(ThreadPoolTests, TestMultipleThenOnSameFuture) {
     EXPECT_EQ(c1.load(), 10);
     EXPECT_EQ(c2.load(), 20);
 }
+
+namespace {
+    // Counts its live instances, to observe when a shared state releases its value.
+    struct Tracked {
+        static inline int alive = 0;
+        int value;
+        explicit Tracked(int v) : value(v) { ++alive; }
+        Tracked(const Tracked& other) : value(other.value) { ++alive; }
+        Tracked(Tracked&& other) noexcept : value(other.value) { ++alive; }
+        Tracked& operator=(const Tracked&) = default;
+        Tracked& operator=(Tracked&&) noexcept = default;
+        ~Tracked() { --alive; }
+    };
+
+    // Minimal intrusively counted state for StateRef.
+    struct CountedState {
+        static inline int destroyed = 0;
+        std::atomic<uint32_t> refs_ {1};
+        int payload;
+        explicit CountedState(int p) : payload(p) {}
+        ~CountedState() { ++destroyed; }
+    };
+}
+
+TEST(StateRefTests, CopyMoveAndLastRelease) {
+    using rts::async::StateRef;
+    CountedState::destroyed = 0;
+    {
+        auto a = StateRef<CountedState>::make(7);
+        EXPECT_EQ(a->payload, 7);
+        EXPECT_EQ(a->refs_.load(), 1u);
+
+        StateRef<CountedState> b = a;              // Copy: one more reference.
+        EXPECT_EQ(a.get(), b.get());
+        EXPECT_EQ(a->refs_.load(), 2u);
+
+        StateRef<CountedState> c = std::move(b);   // Move: same count, source emptied.
+        EXPECT_FALSE(b);
+        EXPECT_EQ(c->refs_.load(), 2u);
+
+        a.reset();
+        EXPECT_EQ(CountedState::destroyed, 0);
+        EXPECT_EQ(c->refs_.load(), 1u);
+
+        b = c;                                     // Copy-assign into an empty handle.
+        c = StateRef<CountedState>{};              // Move-assign releases c's reference.
+        EXPECT_EQ(b->refs_.load(), 1u);
+        EXPECT_EQ(CountedState::destroyed, 0);
+    }
+    EXPECT_EQ(CountedState::destroyed, 1);         // Destroyed exactly once, by the last handle.
+}
+
+TEST(StateRefTests, FutureOutlivesPromise) {
+    Tracked::alive = 0;
+    {
+        std::optional<rts::async::Future<Tracked>> f;
+        {
+            rts::async::Promise<Tracked> p;
+            f.emplace(p.get_future());
+            p.set_value(Tracked(42));
+        }
+        ASSERT_TRUE(f->is_ready());
+        EXPECT_EQ(f->get().value, 42);
+        EXPECT_GE(Tracked::alive, 1);              // The state still holds the value.
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(StateRefTests, PromiseOutlivesFuture) {
+    Tracked::alive = 0;
+    {
+        rts::async::Promise<Tracked> p;
+        { auto f = p.get_future(); }
+        p.set_value(Tracked(1));                   // Nobody is listening; the state stays valid.
+        EXPECT_EQ(Tracked::alive, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "api.h"
+#include "utils.h"
+
+
+TEST(TaskGraphTests, RunsNodesAfterTheirPredecessors) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    // Diamond: a -> {b, c} -> d, run many times with the same counters.
+    std::atomic<int> clock {0};
+    int a_at = -1, b_at = -1, c_at = -1, d_at = -1;
+    rts::graph::Graph g;
+    auto a = g.emplace([&] { a_at = clock++; });
+    auto b = g.emplace([&] { b_at = clock++; });
+    auto c = g.emplace([&] { c_at = clock++; });
+    auto d = g.emplace([&] { d_at = clock++; });
+    a.precede(b, c);
+    d.succeed(b, c);
+    EXPECT_EQ(g.size(), 4u);
+
+    for (int run = 0; run < 1000; ++run) {
+        g.run().get();
+        ASSERT_EQ(clock.load(), 4 * (run + 1));
+        ASSERT_LT(a_at, b_at);
+        ASSERT_LT(a_at, c_at);
+        ASSERT_LT(b_at, d_at);
+        ASSERT_LT(c_at, d_at);
+    }
+
+    // Layers fully connected to the next one: every node runs once per run.
+    constexpr int WIDTH = 16, DEPTH = 8;
+    std::vector<std::atomic<int>> runs(WIDTH * DEPTH);
+    std::vector<std::atomic<int>> layer_done(DEPTH);
+    rts::graph::Graph layers;
+    std::vector<rts::graph::Node> nodes;
+    for (int layer = 0; layer < DEPTH; ++layer) {
+        for (int i = 0; i < WIDTH; ++i) {
+            nodes.push_back(layers.emplace([&, layer, i] {
+                if (layer > 0) {
+                    EXPECT_EQ(layer_done[layer - 1].load() % WIDTH, 0);
+                }
+                runs[layer * WIDTH + i]++;
+                layer_done[layer]++;
+            }));
+            if (layer > 0) {
+                for (int j = 0; j < WIDTH; ++j)
+                    nodes[(layer - 1) * WIDTH + j].precede(nodes.back());
+            }
+        }
+    }
+    for (int run = 1; run <= 50; ++run) {
+        layers.run().get();
+        for (auto& count : runs)
+            ASSERT_EQ(count.load(), run);
+    }
+
+    // From a worker, and an empty graph.
+    rts::async::spawn([&g] { g.run().get(); }).get();
+    EXPECT_EQ(clock.load(), 4004);
+    rts::graph::Graph empty;
+    empty.run().get();
+
+    rts::finalize_soft();
+}
+
+TEST(TaskGraphTests, PropagatesExceptionsAndSkipsSuccessors) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    std::atomic<int> after {0};
+    bool fail = true;
+    rts::graph::Graph g;
+    auto first = g.emplace([&fail] {
+        if (fail)
+            throw std::runtime_error("node");
+    });
+    auto second = g.emplace([&after] { after++; });
+    first.precede(second);
+
+    EXPECT_THROW(g.run().get(), std::runtime_error);
+    EXPECT_EQ(after.load(), 0);
+
+    // The graph can run again once the failure is fixed.
+    fail = false;
+    g.run().get();
+    EXPECT_EQ(after.load(), 1);
+
+    rts::finalize_soft();
+}
+
+TEST(TaskGraphTests, RejectsCycles) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    std::atomic<int> ran {0};
+    rts::graph::Graph g;
+    auto a = g.emplace([&ran] { ran++; });
+    auto b = g.emplace([&ran] { ran++; });
+    auto c = g.emplace([&ran] { ran++; });
+    a.precede(b);
+    b.precede(c);
+    c.precede(b);
+
+    // No node runs, even the root, and the graph can be run again.
+    EXPECT_THROW(g.run().get(), std::logic_error);
+    EXPECT_THROW(g.run().get(), std::logic_error);
+    EXPECT_EQ(ran.load(), 0);
+
+    // A graph without roots is rejected too.
+    rts::graph::Graph loop;
+    auto x = loop.emplace([&ran] { ran++; });
+    auto y = loop.emplace([&ran] { ran++; });
+    x.precede(y);
+    y.precede(x);
+    EXPECT_THROW(rts::async::spawn([&loop] { loop.run().get(); }).get(), std::logic_error);
+    EXPECT_EQ(ran.load(), 0);
+
+    rts::finalize_soft();
+}
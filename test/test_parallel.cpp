@@ -0,0 +1,310 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "api.h"
+#include "utils.h"
+
+
+TEST(ParallelForTests, VisitsEveryIndexOnce) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    for (const int size : {0, 1, 7, 1000, 100'000}) {
+        std::vector<std::atomic<int>> visits(size);
+        rts::parallel_for(0, size, [&visits](int i) {
+            visits[i].fetch_add(1, std::memory_order_relaxed);
+        });
+        for (int i = 0; i < size; ++i)
+            ASSERT_EQ(visits[i].load(), 1) << "size " << size << ", index " << i;
+    }
+
+    // Explicit grain, and chunks never larger than it.
+    std::atomic<long> sum {0};
+    rts::parallel_for_chunks(size_t{10}, size_t{10'010}, [&sum](size_t b, size_t e) {
+        EXPECT_LE(e - b, 16u);
+        long local = 0;
+        for (size_t i = b; i < e; ++i)
+            local += static_cast<long>(i);
+        sum.fetch_add(local, std::memory_order_relaxed);
+    }, 16);
+    EXPECT_EQ(sum.load(), (10L + 10'009L) * 10'000L / 2);
+
+    rts::finalize_soft();
+}
+
+TEST(ParallelForTests, NestedAndFromWorkers) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    // Called from a worker, with a nested loop per iteration: waiting helps instead of blocking.
+    std::vector<std::atomic<int>> cells(64 * 64);
+    rts::async::spawn([&cells] {
+        rts::parallel_for(0, 64, [&cells](int row) {
+            rts::parallel_for(0, 64, [&cells, row](int col) {
+                cells[row * 64 + col].fetch_add(1, std::memory_order_relaxed);
+            });
+        });
+    }).get();
+    for (auto& cell : cells)
+        ASSERT_EQ(cell.load(), 1);
+
+    rts::finalize_soft();
+}
+
+TEST(ParallelForTests, PropagatesExceptions) {
+    pin_to_core(5);
+    rts::initialize_runtime(3, 1024);
+
+    EXPECT_THROW(rts::parallel_for(0, 10'000, [](int i) {
+        if (i == 4321)
+            throw std::runtime_error("boom");
+    }), std::runtime_error);
+
+    // The runtime is still usable afterwards.
+    std::atomic<int> count {0};
+    rts::parallel_for(0, 100, [&count](int) { ++count; });
+    EXPECT_EQ(count.load(), 100);
+
+    rts::finalize_soft();
+}
+
+TEST(ParallelReduceTests, SumsAndCombinesWorkerSlots) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    std::vector<long> values(200'000);
+    std::iota(values.begin(), values.end(), 1);
+    const long expected = 200'000L * 200'001L / 2;
+
+    // From outside the runtime, with the default and a tiny grain.
+    EXPECT_EQ(rts::parallel_reduce(values, 0L, std::plus<>{}, std::plus<>{}), expected);
+    EXPECT_EQ(rts::parallel_reduce(values, 0L, std::plus<>{}, std::plus<>{}, 3), expected);
+    EXPECT_EQ(rts::parallel_reduce(std::vector<long>{}, 1L, std::multiplies<>{}, std::multiplies<>{}), 1L);
+
+    // From a worker, over an index range, with an accumulator of a different type.
+    const auto count = rts::async::spawn([] {
+        return rts::parallel_reduce(std::views::iota(0, 10'000), size_t{0},
+                                    [](size_t acc, int i) { return acc + (i % 3 == 0); },
+                                    std::plus<>{});
+    }).get();
+    EXPECT_EQ(count, 3334u);
+
+    EXPECT_EQ(rts::parallel_transform_reduce(values, 0.0, std::plus<>{},
+                                             [](long v) { return v * 0.5; }),
+              static_cast<double>(expected) * 0.5);
+
+    EXPECT_THROW(rts::parallel_reduce(values, 0L, [](long acc, long v) {
+        if (v == 12'345)
+            throw std::runtime_error("boom");
+        return acc + v;
+    }, std::plus<>{}), std::runtime_error);
+
+    rts::finalize_soft();
+}
+
+TEST(ExecutionPolicyTests, StandardAlgorithms) {
+    pin_to_core(5);
+    rts::initialize_runtime(3, 1024);
+    using rts::execution::par;
+
+    std::vector<int> v(100'003);
+    rts::fill(par, v.begin(), v.end(), 2);
+    rts::for_each(par, v.begin(), v.end(), [](int& x) { x += 1; });
+    EXPECT_EQ(std::count(v.begin(), v.end(), 3), static_cast<long>(v.size()));
+    EXPECT_EQ(rts::for_each_n(par, v.begin(), 10, [](int& x) { x = 0; }), v.begin() + 10);
+    EXPECT_EQ(v[9], 0);
+    EXPECT_EQ(v[10], 3);
+
+    std::iota(v.begin(), v.end(), 0);
+    std::vector<long> squares(v.size());
+    EXPECT_EQ(rts::transform(par, v.begin(), v.end(), squares.begin(), [](int x) { return 1L * x * x; }),
+              squares.end());
+    std::vector<long> expected(v.size());
+    std::transform(v.begin(), v.end(), expected.begin(), [](int x) { return 1L * x * x; });
+    EXPECT_EQ(squares, expected);
+
+    std::vector<long> sums(v.size());
+    rts::transform(par, v.begin(), v.end(), squares.begin(), sums.begin(), std::plus<>{});
+    EXPECT_EQ(sums[1000], 1000L + 1000L * 1000L);
+
+    // reduce / transform_reduce follow std semantics: `init` is used exactly once.
+    EXPECT_EQ(rts::reduce(par, v.begin(), v.end(), 10L), std::reduce(v.begin(), v.end(), 10L));
+    EXPECT_EQ(rts::reduce(par, v.begin(), v.end()), std::reduce(v.begin(), v.end()));
+    EXPECT_EQ(rts::reduce(par, v.begin(), v.end(), 0, [](int a, int b) { return std::max(a, b); }), 100'002);
+    EXPECT_EQ(rts::reduce(par, v.begin(), v.begin(), 7L), 7L);
+    EXPECT_EQ(rts::transform_reduce(par, v.begin(), v.end(), 1L, std::plus<>{}, [](int x) { return x % 2L; }),
+              1L + 50'001L);
+    EXPECT_EQ(rts::transform_reduce(par, v.begin(), v.begin() + 10'000, v.begin(), 0L),
+              std::transform_reduce(v.begin(), v.begin() + 10'000, v.begin(), 0L));
+    EXPECT_EQ(rts::count_if(par, v.begin(), v.end(), [](int x) { return x % 3 == 0; }), 33'335);
+
+    // From a worker, nothing blocks.
+    EXPECT_EQ(rts::async::spawn([&v] { return rts::reduce(par, v.begin(), v.end(), 0L); }).get(),
+              std::reduce(v.begin(), v.end(), 0L));
+
+    rts::finalize_soft();
+}
+
+TEST(ParallelSortTests, SortsAndMerges) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    std::mt19937 rng(42);
+    for (const int size : {0, 1, 100, 4097, 100'000, 300'001}) {
+        std::vector<int> v(size);
+        for (int& x : v)
+            x = static_cast<int>(rng() % 1000);
+        std::vector<int> expected = v;
+        std::sort(expected.begin(), expected.end());
+        rts::parallel_sort(v.begin(), v.end());
+        ASSERT_EQ(v, expected) << "size " << size;
+
+        rts::parallel_sort(v.begin(), v.end(), std::greater<>{});
+        ASSERT_TRUE(std::is_sorted(v.begin(), v.end(), std::greater<>{})) << "size " << size;
+    }
+
+    // Stable: equal keys keep their input order.
+    std::vector<std::pair<int, int>> records(200'000);
+    for (int i = 0; i < static_cast<int>(records.size()); ++i)
+        records[i] = {static_cast<int>(rng() % 100), i};
+    std::vector<std::pair<int, int>> expected = records;
+    auto by_key = [](const auto& a, const auto& b) { return a.first < b.first; };
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    rts::stable_sort(rts::execution::par, records.begin(), records.end(), by_key);
+    EXPECT_EQ(records, expected);
+
+    // Elements without a default constructor.
+    std::vector<std::string> words;
+    for (int i = 0; i < 20'000; ++i)
+        words.push_back(std::to_string(rng()));
+    std::vector<std::string> sorted_words = words;
+    std::sort(sorted_words.begin(), sorted_words.end());
+    rts::sort(rts::execution::par, words.begin(), words.end());
+    EXPECT_EQ(words, sorted_words);
+
+    // Merge of runs with many ties: run 1 comes first.
+    std::vector<std::pair<int, int>> run1(60'000), run2(90'000);
+    for (int i = 0; i < 60'000; ++i)
+        run1[i] = {i / 10, 1};
+    for (int i = 0; i < 90'000; ++i)
+        run2[i] = {i / 15, 2};
+    std::vector<std::pair<int, int>> merged(run1.size() + run2.size());
+    std::vector<std::pair<int, int>> expected_merge(merged.size());
+    std::merge(run1.begin(), run1.end(), run2.begin(), run2.end(), expected_merge.begin(), by_key);
+    EXPECT_EQ(rts::parallel_merge(run1.begin(), run1.end(), run2.begin(), run2.end(), merged.begin(), by_key),
+              merged.end());
+    EXPECT_EQ(merged, expected_merge);
+
+    // From a worker, and with a throwing comparison.
+    std::vector<int> v(50'000);
+    std::iota(v.rbegin(), v.rend(), 0);
+    rts::async::spawn([&v] { rts::parallel_sort(v.begin(), v.end()); }).get();
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    EXPECT_THROW(rts::parallel_sort(v.begin(), v.end(), [](int a, int b) {
+        if (a == 12'345)
+            throw std::runtime_error("boom");
+        return a > b;
+    }), std::runtime_error);
+
+    rts::finalize_soft();
+}
+
+TEST(ParallelSortTests, ParallelInvoke) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    int a = 0, b = 0;
+    rts::parallel_invoke([&a] { a = 1; }, [&b] { b = 2; });
+    EXPECT_EQ(a + b, 3);
+
+    // Both sides complete before the exception escapes.
+    std::atomic<bool> other_ran {false};
+    EXPECT_THROW(rts::async::spawn([&other_ran] {
+        rts::parallel_invoke([] { throw std::runtime_error("left"); },
+                             [&other_ran] { other_ran = true; });
+    }).get(), std::runtime_error);
+    EXPECT_TRUE(other_ran.load());
+
+    rts::finalize_soft();
+}
+
+TEST(ParallelScanTests, ScansCopiesAndPartitions) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    for (const int size : {0, 1, 1000, 16'385, 300'001}) {
+        std::vector<long> v(size);
+        std::iota(v.begin(), v.end(), 1L);
+
+        std::vector<long> out(size), expected(size);
+        std::inclusive_scan(v.begin(), v.end(), expected.begin());
+        EXPECT_EQ(rts::parallel_inclusive_scan(v.begin(), v.end(), out.begin()), out.end());
+        ASSERT_EQ(out, expected) << "size " << size;
+
+        std::exclusive_scan(v.begin(), v.end(), expected.begin(), 7L);
+        rts::parallel_exclusive_scan(v.begin(), v.end(), out.begin(), 7L);
+        ASSERT_EQ(out, expected) << "size " << size;
+
+        // In place, with an init and a non-commutative operation.
+        std::vector<std::string> s(size);
+        for (int i = 0; i < size; ++i)
+            s[i] = std::string(1, static_cast<char>('a' + i % 26));
+        std::vector<std::string> expected_s(size);
+        auto concat_tail = [](const std::string& a, const std::string& b) {
+            return (a + b).substr(a.size() + b.size() > 8 ? a.size() + b.size() - 8 : 0);
+        };
+        std::inclusive_scan(s.begin(), s.end(), expected_s.begin(), concat_tail, std::string(">"));
+        rts::parallel_inclusive_scan(s.begin(), s.end(), s.begin(), concat_tail, std::string(">"));
+        ASSERT_EQ(s, expected_s) << "size " << size;
+
+        auto odd = [](long x) { return x % 2 == 1; };
+        std::vector<long> copied(size), expected_copy(size);
+        const auto expected_end = std::copy_if(v.begin(), v.end(), expected_copy.begin(), odd);
+        const auto copied_end = rts::parallel_copy_if(v.begin(), v.end(), copied.begin(), odd);
+        ASSERT_EQ(copied_end - copied.begin(), expected_end - expected_copy.begin()) << "size " << size;
+        ASSERT_EQ(copied, expected_copy) << "size " << size;
+
+        std::vector<long> partitioned = v;
+        std::vector<long> expected_partition = v;
+        auto div3 = [](long x) { return x % 3 == 0; };
+        const auto expected_mid = std::stable_partition(expected_partition.begin(), expected_partition.end(), div3);
+        const auto mid = rts::parallel_partition(partitioned.begin(), partitioned.end(), div3);
+        ASSERT_EQ(mid - partitioned.begin(), expected_mid - expected_partition.begin()) << "size " << size;
+        ASSERT_EQ(partitioned, expected_partition) << "size " << size;
+    }
+
+    // Policy overloads, from a worker, with elements that are not default-initializable.
+    struct Key {
+        explicit Key(int v) : value(v) {}
+        int value;
+        bool operator==(const Key&) const = default;
+    };
+    std::vector<Key> keys;
+    for (int i = 0; i < 100'000; ++i)
+        keys.emplace_back(i % 1000);
+    std::vector<Key> expected_keys = keys;
+    auto small = [](const Key& k) { return k.value < 100; };
+    std::stable_partition(expected_keys.begin(), expected_keys.end(), small);
+    rts::async::spawn([&] { rts::partition(rts::execution::par, keys.begin(), keys.end(), small); }).get();
+    EXPECT_EQ(keys, expected_keys);
+
+    std::vector<int> ones(100'000, 1), prefix(100'000);
+    rts::exclusive_scan(rts::execution::par, ones.begin(), ones.end(), prefix.begin(), 0);
+    EXPECT_EQ(prefix[99'999], 99'999);
+    rts::inclusive_scan(rts::execution::par, ones.begin(), ones.end(), prefix.begin(), std::plus<>{}, 10);
+    EXPECT_EQ(prefix[99'999], 100'010);
+    EXPECT_EQ(rts::copy_if(rts::execution::par, prefix.begin(), prefix.end(), ones.begin(),
+                           [](int x) { return x > 100'000; }) - ones.begin(), 10);
+
+    rts::finalize_soft();
+}
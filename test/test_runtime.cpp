@@ -1,8 +1,27 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <set>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "api.h"
 #include "utils.h"
+#include "combining_tree.h"
 #include "default_thread_pool.h"
+#include "latency.h"
+#include "metrics.h"
+#include "profile.h"
+#include "slab_allocator.h"
+#include "topology.h"
+#include "trace.h"
+#include "work_stealing_deque.h"
 
 
 // ─────────────────────────────────────────────────────────────
@@ -92,6 +111,854 @@ TEST(ThreadPoolTests, TestWorkStealing){
 }
 
 
+TEST(ThreadPoolTests, TestWakeParkedWorkers) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024, rts::core::PARK_IDLE);
+
+    std::atomic<int> completed {0};
+    for (int round = 0; round < 10; ++round) {
+        // Give the workers time to exhaust their spin window and park.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        for (int i = 0; i < 100; ++i) {
+            rts::enqueue([&completed] { completed.fetch_add(1, std::memory_order_relaxed); });
+        }
+        while (completed.load(std::memory_order_acquire) != (round + 1) * 100) {}
+    }
+
+    rts::finalize_soft();
+    EXPECT_EQ(completed.load(), 1000);
+}
+
+namespace {
+    // Non-trivially-copyable functor that opts into inline storage.
+    struct RelocatableCounter {
+        int* destroyed;
+        int* invoked;
+        ~RelocatableCounter() { ++*destroyed; }
+        void operator()() const { ++*invoked; }
+    };
+}
+
+template <>
+struct rts::core::is_trivially_relocatable<RelocatableCounter> : std::true_type {};
+
+TEST(TaskTests, InlineAndHeapStorage) {
+    using rts::core::Task;
+    int value = 0;
+    auto small = [&value] { ++value; };
+    std::array<char, 2 * rts::core::kTaskInlineSize> big {};
+    auto large = [&value, big] { value += static_cast<int>(big.size()); };
+    auto shared = [ptr = std::make_shared<int>(1), &value] { value += *ptr; };
+
+    static_assert(Task::stores_inline<decltype(small)>);
+    static_assert(!Task::stores_inline<decltype(large)>);
+    static_assert(!Task::stores_inline<decltype(shared)>);
+    static_assert(sizeof(Task) == rts::core::kTaskInlineSize + 2 * sizeof(void*)
+                                  + (rts::core::kLatencyStats ? sizeof(uint64_t) : 0));
+
+    for (Task task : {Task(small), Task(large), Task(shared)}) {
+        Task copy = task;   // Queues copy Tasks bitwise.
+        ASSERT_TRUE(copy);
+        copy();
+        copy.destroy();
+        EXPECT_FALSE(copy);
+    }
+    EXPECT_EQ(value, 1 + 2 * static_cast<int>(rts::core::kTaskInlineSize) + 1);
+
+    int destroyed = 0;
+    int invoked = 0;
+    static_assert(Task::stores_inline<RelocatableCounter>);
+    Task task(RelocatableCounter{&destroyed, &invoked});
+    destroyed = 0;  // Ignore the temporary.
+    task();
+    task.destroy();
+    EXPECT_EQ(invoked, 1);
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(SlabAllocatorTests, LocalAndRemoteFree) {
+    using rts::core::SlabAllocator;
+    SlabAllocator& slab = SlabAllocator::local();
+
+    // A block freed on its own thread is reused by the next allocation of its size class.
+    void* a = slab.allocate(40);
+    SlabAllocator::deallocate(a, 40);
+    EXPECT_EQ(slab.allocate(48), a);
+
+    // Blocks freed by another thread come back once the owner's free list runs dry.
+    std::vector<void*> blocks;
+    for (int i = 0; i < 1000; ++i) {
+        blocks.push_back(slab.allocate(64));
+    }
+    std::thread([&] {
+        for (void* p : blocks) {
+            SlabAllocator::deallocate(p, 64);
+        }
+    }).join();
+    std::set<void*> freed(blocks.begin(), blocks.end());
+    size_t reused = 0;
+    for (int i = 0; i < 1'000'000 && reused < blocks.size(); ++i) {
+        reused += freed.erase(slab.allocate(64));
+    }
+    EXPECT_EQ(reused, blocks.size()) << "remote-freed blocks not reused";
+
+    // Above 256 bytes, size classes step by half powers of two: 300 and 384 bytes share one.
+    void* frame = slab.allocate(300);
+    SlabAllocator::deallocate(frame, 300);
+    EXPECT_EQ(slab.allocate(384), frame);
+    SlabAllocator::deallocate(frame, 384);
+    EXPECT_TRUE(SlabAllocator::fits(rts::core::kMaxSlabBlockSize, 16));
+    std::vector<void*> large;
+    for (size_t size = 257; size <= rts::core::kMaxSlabBlockSize; size += 61)
+        large.push_back(slab.allocate(size));
+    for (size_t i = 0; i < large.size(); ++i)
+        SlabAllocator::deallocate(large[i], 257 + 61 * i);
+
+    // Oversized and over-aligned requests fall back to operator new.
+    EXPECT_FALSE(SlabAllocator::fits(rts::core::kMaxSlabBlockSize + 1, 8));
+    EXPECT_FALSE(SlabAllocator::fits(64, 64));
+    void* big = SlabAllocator::allocate_bytes(4096, 8);
+    SlabAllocator::deallocate_bytes(big, 4096, 8);
+    SlabAllocator::deallocate(a, 48);
+}
+
+TEST(CombiningTreeTests, LastArrivalCompletes) {
+    // Flat counter, exact multiples of the fan-in, ragged last groups and several levels.
+    for (const size_t size : {1u, 5u, 64u, 65u, 1000u, 4097u}) {
+        for (const size_t fan_in : {size_t{2}, size_t{3}, size_t{64}, SIZE_MAX}) {
+            rts::core::CombiningTree tree(size, fan_in);
+            EXPECT_EQ(tree.depth() == 0, size <= fan_in);
+
+            // Arrive in a scrambled order (7919 is a prime not dividing any size), so groups
+            // complete out of order: only the very last arrival completes the tree.
+            for (size_t i = 0; i < size; ++i)
+                ASSERT_EQ(tree.arrive(i * 7919 % size), i + 1 == size) << size << "/" << fan_in << " at " << i;
+        }
+    }
+}
+
+TEST(CombiningTreeTests, ConcurrentArrivals) {
+    constexpr size_t SIZE = 100'000;
+    constexpr int THREADS = 4;
+
+    rts::core::CombiningTree tree(SIZE, 8);
+    std::vector<int> written(SIZE, 0);
+    std::atomic<int> completions {0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < SIZE; i += THREADS) {
+                written[i] = 1;
+                if (tree.arrive(i)) {
+                    // The last arrival sees every write made before the other arrivals.
+                    EXPECT_EQ(std::count(written.begin(), written.end(), 1), static_cast<long>(SIZE));
+                    completions.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(completions.load(), 1);
+}
+
+TEST(ContinuationStateTests, RegisterRacesWithMarkReady) {
+    constexpr int ROUNDS = 500;
+    constexpr int REGISTRANTS = 3;
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        rts::async::ContinuationState state;
+        std::atomic<int> ran {0};
+
+        std::vector<std::thread> registrants;
+        for (int r = 0; r < REGISTRANTS; ++r) {
+            registrants.emplace_back([&] {
+                for (int i = 0; i < 2; ++i) {
+                    rts::core::Task cont([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+                    if (!state.try_register(cont)) {
+                        // Already ready: the registrant runs its own continuation.
+                        cont();
+                        cont.destroy();
+                    }
+                }
+            });
+        }
+        state.mark_ready([](rts::core::Task&& cont) noexcept {
+            cont();
+            cont.destroy();
+        });
+        for (auto& t : registrants) {
+            t.join();
+        }
+
+        // Every continuation runs exactly once, whoever dispatches it.
+        ASSERT_EQ(ran.load(), REGISTRANTS * 2) << "round " << round;
+        ASSERT_TRUE(state.is_ready());
+    }
+
+    // Registering on a ready state hands the continuation back.
+    rts::async::ContinuationState ready;
+    ready.mark_ready([](rts::core::Task&&) noexcept {});
+    rts::core::Task cont([] {});
+    EXPECT_FALSE(ready.try_register(cont));
+}
+
+TEST(WorkStealingDequeTests, OwnerOrderAndGrowth) {
+    rts::core::WorkStealingDeque<int> owner(4);
+    rts::core::WorkStealingDeque<int> thief(4);
+    for (int i = 0; i < 100; ++i) {
+        owner.emplace(i);
+    }
+    EXPECT_EQ(owner.size(), 100);
+    EXPECT_GE(owner.capacity(), 100);
+
+    // Thieves take the older half from the top, in order.
+    EXPECT_EQ(thief.steal_half_from(owner), 50);
+    EXPECT_EQ(owner.size(), 50);
+    EXPECT_EQ(thief.steal(), 0);
+
+    // The owner pops LIFO.
+    EXPECT_EQ(owner.pop(), 99);
+    EXPECT_EQ(thief.pop(), 49);
+}
+
+TEST(WorkStealingDequeTests, ConcurrentStealHalf) {
+    constexpr int ITEMS = 200'000;
+    constexpr int THIEVES = 3;
+    rts::core::WorkStealingDeque<int> owner(64);
+    std::vector<std::atomic<int>> seen(ITEMS);
+    std::atomic<bool> done {false};
+
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < THIEVES; ++i) {
+        thieves.emplace_back([&] {
+            rts::core::WorkStealingDeque<int> local(64);
+            while (!done.load(std::memory_order_acquire) || !owner.empty()) {
+                local.steal_half_from(owner);
+                while (auto x = local.pop()) {
+                    seen[*x].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < ITEMS; ++i) {
+        owner.emplace(i);
+        if (i % 3 == 0) {
+            if (auto x = owner.pop()) {
+                seen[*x].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    while (auto x = owner.pop()) {
+        seen[*x].fetch_add(1, std::memory_order_relaxed);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& t : thieves) {
+        t.join();
+    }
+
+    // Every element is taken exactly once.
+    for (int i = 0; i < ITEMS; ++i) {
+        ASSERT_EQ(seen[i].load(), 1) << "element " << i;
+    }
+}
+
+TEST(ThreadPoolTests, TestConcurrentProducers) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 256);
+
+    constexpr int PRODUCERS = 8;
+    constexpr int LOOP = 10'000;
+
+    std::atomic<int> completed {0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&completed] {
+            for (int i = 0; i < LOOP; ++i) {
+                rts::enqueue([&completed] { completed.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    rts::finalize_soft();
+    EXPECT_EQ(completed.load(), PRODUCERS * LOOP);
+}
+
+TEST(ThreadPoolTests, TestSpinIdleMode) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024, rts::core::SPIN_IDLE);
+
+    std::atomic<int> completed {0};
+    for (int i = 0; i < 1000; ++i) {
+        rts::enqueue([&completed] { completed.fetch_add(1, std::memory_order_relaxed); });
+    }
+
+    rts::finalize_soft();
+    EXPECT_EQ(completed.load(), 1000);
+}
+
+TEST(ThreadPoolTests, TestInlineContinuationDepth) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    constexpr int CHAIN = 10'000;
+    std::atomic<int> ran {0};
+    std::atomic<size_t> max_depth {0};
+
+    // Register the whole chain first, so that fulfilling the root runs it from a worker.
+    rts::async::Promise<void> root;
+    auto fut = root.get_future();
+    for (int i = 0; i < CHAIN; ++i) {
+        fut = fut.then([&ran, &max_depth] {
+            ran.fetch_add(1, std::memory_order_relaxed);
+            const size_t depth = rts::core::tls_continuation_depth;
+            if (depth > max_depth.load(std::memory_order_relaxed))
+                max_depth.store(depth, std::memory_order_relaxed);
+        });
+    }
+    rts::enqueue([root]() mutable { root.set_value(); });
+    fut.get();
+
+    rts::finalize_soft();
+    EXPECT_EQ(ran.load(), CHAIN);
+    EXPECT_LE(max_depth.load(), rts::core::kMaxInlineContinuationDepth);
+    if constexpr (rts::core::kMaxInlineContinuationDepth > 0) {
+        EXPECT_GT(max_depth.load(), 0) << "no continuation ran inline";
+    }
+}
+
+namespace {
+    // Divide-and-conquer written in blocking style: each task waits on its children.
+    int blocking_fibonacci(int n) {
+        if (n <= 1)
+            return n;
+        auto f1 = rts::async::spawn(blocking_fibonacci, n - 1);
+        auto f2 = rts::async::spawn(blocking_fibonacci, n - 2);
+        return f1.get() + f2.get();
+    }
+}
+
+TEST(ThreadPoolTests, TestHelpWhileWaiting) {
+    pin_to_core(5);
+    // A single worker must run the children itself instead of deadlocking.
+    for (size_t threads : {1, 4}) {
+        rts::initialize_runtime(threads, 1024);
+        auto fut = rts::async::spawn(blocking_fibonacci, 16);
+        EXPECT_EQ(fut.get(), 987) << threads << " workers";
+        rts::finalize_soft();
+    }
+}
+
+TEST(ThreadPoolTests, TestStatsSnapshot) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    const rts::core::RuntimeStats before = rts::stats();
+    ASSERT_EQ(before.workers.size(), 4u);
+
+    std::atomic<int> done {0};
+    for (int i = 0; i < 1000; ++i)
+        rts::enqueue([&done] { ++done; });
+    EXPECT_EQ(rts::async::spawn(blocking_fibonacci, 16).get(), 987);
+    rts::parallel_invoke([] {}, [] {});  // Pushes on a worker's own WSQ.
+    while (done.load() != 1000)
+        std::this_thread::yield();
+    // Continuations fulfilled on a worker run inline: executed, but never popped.
+    rts::async::spawn([] {
+        rts::async::Promise<int> p;
+        auto chained = p.get_future().then([](int x) { return x + 1; }).then([](int x) { return x + 1; });
+        p.set_value(1);
+        return chained.get();
+    }).get();
+
+    // Read while the workers keep running.
+    const rts::core::RuntimeStats after = rts::stats();
+    EXPECT_GE(after.saturation, 0.0);
+    EXPECT_LE(after.saturation, 1.0);
+
+    rts::core::WorkerStats sum;
+    for (const auto& worker : after.workers)
+        sum += worker;
+    EXPECT_EQ(sum.tasks_executed, after.total.tasks_executed);
+    EXPECT_LE(after.total.steal_successes, after.total.steal_attempts);
+    EXPECT_LE(after.total.steal_successes, after.total.tasks_stolen);
+    if constexpr (rts::core::kWorkerStats) {
+        // 1000 enqueued tasks, the fibonacci root and its spawned children.
+        EXPECT_GE(after.total.tasks_executed - before.total.tasks_executed, 1001u);
+        EXPECT_GE(after.total.inbox_transfers - before.total.inbox_transfers, 1001u);
+        EXPECT_GE(after.total.local_pops, after.total.inbox_transfers);
+        EXPECT_GE(after.total.tasks_executed - after.total.local_pops, 2u);
+        EXPECT_GT(after.total.local_pushes, 0u);
+    } else {
+        EXPECT_EQ(after.total.tasks_executed, 0u);
+    }
+
+    rts::finalize_soft();
+}
+
+TEST(LatencyTests, HistogramBuckets) {
+    using rts::core::LatencyHistogram;
+    for (uint64_t value : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull, ~0ull}) {
+        const size_t bucket = LatencyHistogram::bucket_of(value);
+        ASSERT_LT(bucket, LatencyHistogram::kBuckets);
+        EXPECT_GE(LatencyHistogram::bucket_max(bucket), value);
+        EXPECT_LE(LatencyHistogram::bucket_max(bucket) - value, value / LatencyHistogram::kSubBuckets);
+        if (bucket != 0) {
+            EXPECT_LT(LatencyHistogram::bucket_max(bucket - 1), value);
+        }
+    }
+
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100'000; ++value)
+        histogram.record(value);
+    rts::core::LatencyDistribution distribution {{}, 1.0};
+    histogram.add_to(distribution.counts);
+    histogram.add_to(distribution.counts);   // Merging doubles every count.
+
+    EXPECT_EQ(distribution.count(), 200'000u);
+    EXPECT_NEAR(distribution.percentile(50), 50'000, 50'000.0 / LatencyHistogram::kSubBuckets);
+    EXPECT_NEAR(distribution.percentile(99), 99'000, 99'000.0 / LatencyHistogram::kSubBuckets);
+    EXPECT_GE(distribution.max(), 100'000);
+    EXPECT_EQ(rts::core::LatencyDistribution{}.percentile(99), 0.0);
+}
+
+TEST(LatencyTests, RuntimeLatencyStats) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    std::atomic<int> done {0};
+    for (int i = 0; i < 100; ++i)
+        rts::enqueue([&done] { ++done; });
+    std::vector<rts::async::Future<int>> futures;
+    for (int i = 0; i < 100; ++i)
+        futures.push_back(rts::async::spawn([i] { return i; }));
+    for (auto& f : futures)
+        f.get();
+    while (done.load() != 100)
+        std::this_thread::yield();
+
+    const rts::core::LatencyStats stats = rts::latency_stats();
+    if constexpr (rts::core::kLatencyStats) {
+        EXPECT_GE(stats.enqueue_to_start.count(), 200u);
+        EXPECT_EQ(stats.spawn_to_ready.count(), 100u);
+        EXPECT_GT(stats.enqueue_to_start.ns_per_tick, 0.0);
+        EXPECT_LE(stats.enqueue_to_start.percentile(50), stats.enqueue_to_start.percentile(99.9));
+        EXPECT_LE(stats.spawn_to_ready.percentile(99), stats.spawn_to_ready.max());
+    } else {
+        EXPECT_EQ(stats.enqueue_to_start.count(), 0u);
+        EXPECT_EQ(stats.spawn_to_ready.count(), 0u);
+    }
+
+    rts::finalize_soft();
+}
+
+TEST(MetricsTests, SegmentRoundTrip) {
+    const std::string name = rts::core::metrics_segment_for(getpid()) + ".roundtrip";
+    rts::core::MetricsSegment publisher;
+    ASSERT_TRUE(publisher.create(name, 3));
+
+    rts::core::MetricsSegment reader;
+    ASSERT_TRUE(reader.open(name));
+    EXPECT_EQ(reader.read()->published_at_ns, 0u);
+
+    rts::core::RuntimeStats stats;
+    stats.workers.resize(3);
+    for (uint64_t i = 0; i < 3; ++i) {
+        stats.workers[i].tasks_executed = 10 * (i + 1);
+        stats.workers[i].parks = i;
+        stats.workers[i].wsq_depth = 100 + i;
+        stats.workers[i].inbox_depth = 7;
+    }
+    stats.saturation = 0.25;
+    publisher.publish(stats);
+
+    const auto snapshot = reader.read();
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ(snapshot->pid, getpid());
+    EXPECT_GT(snapshot->published_at_ns, 0u);
+    ASSERT_EQ(snapshot->stats.workers.size(), 3u);
+    EXPECT_EQ(snapshot->stats.workers[2].tasks_executed, 30u);
+    EXPECT_EQ(snapshot->stats.total.tasks_executed, 60u);
+    EXPECT_EQ(snapshot->stats.total.parks, 3u);
+    EXPECT_EQ(snapshot->stats.workers[1].wsq_depth, 101u);
+    EXPECT_EQ(snapshot->stats.total.inbox_depth, 21u);
+    EXPECT_EQ(snapshot->stats.saturation, 0.25);
+
+    // A publisher killed mid-update leaves the sequence odd: readers give up instead of spinning.
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    void* base = mmap(nullptr, sizeof(rts::core::MetricsHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(base, MAP_FAILED);
+    auto& sequence = static_cast<rts::core::MetricsHeader*>(base)->sequence;
+    sequence.fetch_add(1);
+    EXPECT_FALSE(reader.read());
+    sequence.fetch_add(1);
+    EXPECT_TRUE(reader.read());
+    munmap(base, sizeof(rts::core::MetricsHeader));
+
+    publisher.close();
+    rts::core::MetricsSegment gone;
+    EXPECT_FALSE(gone.open(name));
+}
+
+TEST(MetricsTests, RuntimePublishesStats) {
+    pin_to_core(5);
+    const std::string name = rts::core::metrics_segment_for(getpid());
+    rts::set_metrics_segment(name, std::chrono::milliseconds(5));
+    rts::initialize_runtime(2, 1024);
+
+    std::atomic<int> done {0};
+    for (int i = 0; i < 1000; ++i)
+        rts::enqueue([&done] { ++done; });
+    while (done.load() != 1000)
+        std::this_thread::yield();
+
+    rts::core::MetricsSegment reader;
+    ASSERT_TRUE(reader.open(name));
+    uint64_t executed = 0;
+    for (int i = 0; i < 1000 && executed < 1000; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        executed = reader.read()->stats.total.tasks_executed;
+    }
+    if constexpr (rts::core::kWorkerStats) {
+        EXPECT_EQ(executed, 1000u);
+    }
+    EXPECT_EQ(reader.read()->stats.workers.size(), 2u);
+
+    rts::finalize_soft();
+    rts::set_metrics_segment("");
+    rts::core::MetricsSegment gone;
+    EXPECT_FALSE(gone.open(name));
+}
+
+TEST(ProfileTests, PhaseStatsReport) {
+    using rts::core::Phase;
+    rts::core::WorkerProfile profile;
+    profile.add(Phase::POP, 10);
+    profile.add(Phase::STEAL_SCAN, 20);
+    profile.add(Phase::TRANSFER, 10);
+    profile.add(Phase::EXECUTE, 160);
+    profile.add(Phase::IDLE, 800);
+    profile.add(Phase::EXECUTE, 0);
+
+    const auto stats = rts::core::PhaseStats::load(profile);
+    EXPECT_EQ(stats.total(), 1000u);
+    EXPECT_EQ(stats.scheduling(), 40u);
+    EXPECT_DOUBLE_EQ(stats.overhead(), 0.2);   // Idle time is not overhead.
+    EXPECT_EQ(rts::core::PhaseStats{}.overhead(), 0.0);
+
+    rts::core::ProfileReport report;
+    report.workers = {stats, stats};
+    report.total += stats;
+    report.total += stats;
+    std::ostringstream out;
+    rts::core::write_profile_report(out, report);
+    const std::string text = out.str();
+    EXPECT_NE(text.find("steal scan"), std::string::npos);
+    EXPECT_NE(text.find("80.0%"), std::string::npos);    // Idle share.
+    EXPECT_NE(text.find("20.0%\n"), std::string::npos);  // Overhead column.
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), 4);
+}
+
+TEST(ProfileTests, RuntimeProfile) {
+    pin_to_core(5);
+    rts::core::take_exited_profile();
+    rts::initialize_runtime(2, 1024);
+
+    std::atomic<int> done {0};
+    for (int i = 0; i < 1000; ++i)
+        rts::enqueue([&done] { ++done; });
+    while (done.load() != 1000)
+        std::this_thread::yield();
+
+    const rts::core::ProfileReport report = rts::profile();
+    ASSERT_EQ(report.workers.size(), 2u);
+    rts::finalize_soft();
+    const rts::core::ProfileReport exited = rts::core::take_exited_profile();
+
+    if constexpr (rts::core::kProfile) {
+        EXPECT_GT(report.total[rts::core::Phase::EXECUTE], 0u);
+        EXPECT_GT(report.total[rts::core::Phase::POP], 0u);
+        ASSERT_EQ(exited.workers.size(), 2u);
+        EXPECT_GE(exited.total.total(), report.total.total());
+    } else {
+        EXPECT_EQ(report.total.total(), 0u);
+        EXPECT_TRUE(exited.workers.empty());
+    }
+}
+
+TEST(ProfileTests, IdlePoolHasNoOverhead) {
+    pin_to_core(5);
+    for (const rts::core::IdleMode mode : {rts::core::SPIN_IDLE, rts::core::PARK_IDLE}) {
+        rts::initialize_runtime(2, 1024, mode);
+
+        std::atomic<int> done {0};
+        for (int i = 0; i < 100; ++i)
+            rts::enqueue([&done] { ++done; });
+        while (done.load() != 100)
+            std::this_thread::yield();
+
+        // Once out of work, polling and failed steal scans are idle time, not scheduling.
+        const rts::core::PhaseStats before = rts::profile().total;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        const rts::core::PhaseStats after = rts::profile().total;
+        rts::finalize_soft();
+
+        if constexpr (rts::core::kProfile) {
+            const auto scheduling = static_cast<double>(after.scheduling() - before.scheduling());
+            const auto elapsed = static_cast<double>(after.total() - before.total());
+            EXPECT_GT(after[rts::core::Phase::IDLE], before[rts::core::Phase::IDLE]) << "mode " << mode;
+            EXPECT_LT(scheduling, 0.01 * elapsed) << "mode " << mode;
+        }
+    }
+    rts::core::take_exited_profile();
+}
+
+TEST(TraceTests, RingKeepsLatestEvents) {
+    rts::core::TraceBuffer buffer;
+    const size_t recorded = rts::core::kTraceBufferEvents + 100;
+    for (size_t i = 0; i < recorded; ++i)
+        buffer.record(rts::core::TraceKind::STEAL, i, i % 7);
+
+    const std::vector<rts::core::TraceRecord> records = buffer.snapshot();
+    ASSERT_EQ(records.size(), rts::core::kTraceBufferEvents);
+    for (size_t i = 0; i < records.size(); ++i) {
+        const uint64_t expected = recorded - rts::core::kTraceBufferEvents + i;
+        EXPECT_EQ(records[i].kind, rts::core::TraceKind::STEAL);
+        EXPECT_EQ(records[i].begin, expected);
+        EXPECT_EQ(records[i].value, expected % 7);
+    }
+}
+
+TEST(TraceTests, ChromeTraceKeepsSubMicrosecondDigits) {
+    // One tick per nanosecond: a task 2.5 s into the trace, lasting 1.5 µs, with a
+    // time-stamp counter past 2^56 (the bits left next to the kind of an event).
+    const uint64_t tsc = uint64_t{1} << 57;
+    const auto origin = std::chrono::steady_clock::time_point {};
+    const rts::core::TraceClock start {tsc, origin};
+    const rts::core::TraceClock end {tsc + 10'000'000'000, origin + std::chrono::seconds(10)};
+    rts::core::TraceBuffer buffer;
+    buffer.record(rts::core::TraceKind::TASK, tsc + 2'500'000'250, 1'500);
+    const std::vector<std::vector<rts::core::TraceRecord>> workers {buffer.snapshot()};
+
+    std::ostringstream out;
+    rts::core::write_chrome_trace(out, workers, start, end);
+    const std::string trace = out.str();
+    EXPECT_NE(trace.find("\"ts\":2500000.250,"), std::string::npos) << trace;
+    EXPECT_NE(trace.find("\"dur\":1.500}"), std::string::npos) << trace;
+
+    // The caller's formatting is restored.
+    out.str("");
+    out << 1.0 / 3;
+    EXPECT_EQ(out.str(), "0.333333");
+}
+
+TEST(TraceTests, WriteChromeTrace) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    EXPECT_EQ(rts::async::spawn(blocking_fibonacci, 12).get(), 144);
+
+    // Written while the workers keep running.
+    std::ostringstream out;
+    rts::write_trace(out);
+    const std::string trace = out.str();
+    EXPECT_NE(trace.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_NE(trace.find("\"worker 1\""), std::string::npos);
+    if constexpr (rts::core::kTracing) {
+        EXPECT_NE(trace.find("\"name\":\"task\""), std::string::npos);
+        EXPECT_NE(trace.find("\"name\":\"inbox transfer\""), std::string::npos);
+    } else {
+        EXPECT_EQ(trace.find("\"name\":\"task\""), std::string::npos);
+    }
+
+    rts::finalize_soft();
+}
+
+namespace {
+    thread_local size_t global_news = 0;   ///< Calls to the global operator new on this thread.
+}
+
+// Counts the allocations that bypass the slab (see CoroutineTests.FramesComeFromSlabs).
+void* operator new(std::size_t size) {
+    ++global_news;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    rts::async::task<int> coroutine_fibonacci(int n) {
+        if (n <= 1)
+            co_return n;
+        auto t1 = coroutine_fibonacci(n - 1);
+        auto t2 = coroutine_fibonacci(n - 2);
+        co_return co_await t1 + co_await t2;
+    }
+
+    rts::async::task<void> coroutine_awaiting_futures(std::atomic<int>& sum) {
+        // Futures from spawn() and then() are awaitable too.
+        sum += co_await rts::async::spawn([] { return 40; });
+        sum += co_await rts::async::spawn([] { return 1; }).then([](int x) { return x + 1; });
+    }
+
+    // A frame well above 256 bytes: locals kept across suspensions, an awaited Future,
+    // a nested task and an exception_ptr.
+    rts::async::task<int> coroutine_with_large_frame(int n) {
+        std::array<int, 64> values {};
+        std::exception_ptr error;
+        for (int i = 0; i < n; ++i) {
+            values[static_cast<size_t>(i) % values.size()] += co_await rts::async::spawn([i] { return i; });
+            try {
+                values[0] += co_await coroutine_fibonacci(i % 5);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+        int sum = 0;
+        for (int v : values)
+            sum += v;
+        co_return sum;
+    }
+
+    rts::async::task<int> coroutine_throwing() {
+        co_await rts::async::schedule();
+        throw std::runtime_error("coroutine failure");
+    }
+}
+
+TEST(CoroutineTests, AwaitTasksAndFutures) {
+    pin_to_core(5);
+    for (size_t threads : {1, 4}) {
+        rts::initialize_runtime(threads, 1024);
+
+        EXPECT_EQ(coroutine_fibonacci(18).get(), 2584) << threads << " workers";
+
+        std::atomic<int> sum {0};
+        coroutine_awaiting_futures(sum).get();
+        EXPECT_EQ(sum.load(), 42);
+
+        EXPECT_THROW(coroutine_throwing().get(), std::runtime_error);
+
+        rts::finalize_soft();
+    }
+}
+
+TEST(CoroutineTests, FramesComeFromSlabs) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    // Warm up the calling thread's slab so that only the frame itself could reach operator new.
+    EXPECT_EQ(coroutine_with_large_frame(10).get(), 59);
+    const size_t before = global_news;
+    auto large = coroutine_with_large_frame(10);
+    EXPECT_EQ(global_news, before) << "coroutine frame allocated with operator new";
+    EXPECT_EQ(large.get(), 59);
+
+    rts::finalize_soft();
+}
+
+TEST(CancellationTests, CancelledTasksAreDropped) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+    using rts::async::TaskCancelled;
+
+    std::atomic<int> ran {0};
+    rts::async::CancellationSource live;
+    rts::async::CancellationSource cancelled;
+    cancelled.request_cancellation();
+
+    // Continuations inherit the token of the task they are chained on.
+    auto ok = rts::async::spawn(live.token(), [&ran] { ++ran; return 1; })
+        .then([&ran](int x) { ++ran; return x + 1; });
+    auto dropped = rts::async::spawn(cancelled.token(), [&ran] { ++ran; return 1; })
+        .then([&ran](int x) { ++ran; return x + 1; });
+
+    EXPECT_EQ(ok.get(), 2);
+    EXPECT_TRUE(ok.token() == live.token());
+    EXPECT_THROW(dropped.get(), TaskCancelled);
+    EXPECT_EQ(ran.load(), 2);
+
+    // when_all() fails as soon as one input is cancelled.
+    auto all = rts::async::when_all(rts::async::spawn([] { return 1; }),
+                                    rts::async::spawn(cancelled.token(), [] {}));
+    EXPECT_THROW(all.get(), TaskCancelled);
+
+    rts::finalize_soft();
+}
+
+TEST(CancellationTests, WhenAnyCancelsLosers) {
+    pin_to_core(5);
+    rts::initialize_runtime(1, 1024);
+
+    std::atomic<int> loser_ran {0};
+    // Runs on the only worker, so the loser stays queued until the winner is picked.
+    auto futures = rts::async::spawn([&loser_ran] {
+        rts::async::CancellationSource source;
+        auto loser = rts::async::spawn(source.token(), [&loser_ran] { ++loser_ran; return 1; });
+        auto loser_cont = loser.then([&loser_ran](int x) { ++loser_ran; return x; });
+
+        rts::async::Promise<int> winner;
+        winner.set_value(7);
+        auto any = rts::async::when_any(rts::async::cancel_losers, winner.get_future(), loser);
+        return std::make_tuple(any, loser, loser_cont);
+    }).get();
+
+    auto& [any, loser, loser_cont] = futures;
+    EXPECT_EQ(std::get<0>(any.get()), 7);
+    EXPECT_THROW(loser.get(), rts::async::TaskCancelled);
+    EXPECT_THROW(loser_cont.get(), rts::async::TaskCancelled);
+    EXPECT_EQ(loser_ran.load(), 0);
+
+    rts::finalize_soft();
+}
+
+
+TEST(TopologyTests, ParseCpuList) {
+    EXPECT_EQ(rts::core::parse_cpu_list("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(rts::core::parse_cpu_list("5"), (std::vector<int>{5}));
+    EXPECT_TRUE(rts::core::parse_cpu_list("").empty());
+}
+
+TEST(TopologyTests, VictimTiers) {
+    using rts::core::CpuLocation;
+    // 2 nodes x 2 L3 caches x 2 cores x 2 hyper-threads; CPU i and i+8 are siblings.
+    std::vector<CpuLocation> cpus(16);
+    for (int cpu = 0; cpu < 16; ++cpu) {
+        const int core = cpu % 8;
+        cpus[cpu] = CpuLocation{core, core / 2 * 2, core / 4};
+    }
+    const rts::core::Topology topology(std::move(cpus));
+
+    const auto tiers = topology.victim_tiers(0, 16);
+    EXPECT_EQ(tiers[rts::core::SMT_TIER], (std::vector<uint32_t>{8}));
+    EXPECT_EQ(tiers[rts::core::CACHE_TIER], (std::vector<uint32_t>{1, 9}));
+    EXPECT_EQ(tiers[rts::core::NUMA_TIER], (std::vector<uint32_t>{2, 3, 10, 11}));
+    EXPECT_EQ(tiers[rts::core::REMOTE_TIER].size(), 8);
+
+    // Workers beyond the known CPUs are remote.
+    EXPECT_EQ(topology.tier_between(0, 20), rts::core::REMOTE_TIER);
+    EXPECT_EQ(rts::core::Topology{}.victim_tiers(1, 3)[rts::core::REMOTE_TIER], (std::vector<uint32_t>{0, 2}));
+}
+
 
 // ─────────────────────────────────────────────────────────────
 // -------------------  Parameterized Tests  -------------------
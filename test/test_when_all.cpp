@@ -70,4 +70,55 @@ TEST(ThreadPoolTests, TestWhenAllVoidFuture) {
     EXPECT_NO_THROW({
         rts::finalize_soft();
     }) << "finalize_soft() should not throw.";
-}
\ No newline at end of file
+}
+
+TEST(ThreadPoolTests, TestWhenAllRange) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    std::vector<rts::async::Future<int>> futures;
+    for (int i = 0; i < 1000; ++i)
+        futures.push_back(rts::async::spawn([i] { return i * i; }));
+
+    auto all = rts::async::when_all(futures);
+    const std::vector<int> squares = all.get();
+    ASSERT_EQ(squares.size(), 1000u);
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(squares[i], i * i);
+
+    // Same result when completions are counted by a combining tree.
+    EXPECT_EQ(rts::async::when_all(futures, 4).get(), squares);
+
+    // Void inputs, an empty range, and the first exception failing the result.
+    std::atomic<int> ran {0};
+    std::vector<rts::async::Future<void>> voids;
+    for (int i = 0; i < 100; ++i)
+        voids.push_back(rts::async::spawn([&ran] { ++ran; }));
+    rts::async::when_all(voids).get();
+    EXPECT_EQ(ran.load(), 100);
+    EXPECT_TRUE(rts::async::when_all(std::vector<rts::async::Future<int>>{}).get().empty());
+
+    futures.push_back(rts::async::spawn([]() -> int { throw std::runtime_error("boom"); }));
+    EXPECT_THROW(rts::async::when_all(futures).get(), std::runtime_error);
+
+    rts::finalize_soft();
+}
+
+TEST(ThreadPoolTests, TestWhenAllRangeOfBools) {
+    pin_to_core(5);
+    rts::initialize_runtime(4, 1024);
+
+    // Neighbouring results share a word in a std::vector<bool>: none may be lost.
+    for (int round = 0; round < 20; ++round) {
+        std::vector<rts::async::Future<bool>> futures;
+        for (int i = 0; i < 1000; ++i)
+            futures.push_back(rts::async::spawn([i] { return i % 3 != 0; }));
+
+        const std::vector<bool> flags = rts::async::when_all(futures).get();
+        ASSERT_EQ(flags.size(), 1000u);
+        for (int i = 0; i < 1000; ++i)
+            ASSERT_EQ(flags[i], i % 3 != 0) << "round " << round << ", index " << i;
+    }
+
+    rts::finalize_soft();
+}
@@ -95,3 +95,55 @@ TEST(ThreadPoolTests, TestWhenAnyVoidOnly) {
         rts::finalize_soft();
         }) << "finalize_soft() should not throw.";
 }
+
+TEST(ThreadPoolTests, TestWhenAnyRange) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    std::vector<rts::async::Promise<std::string>> promises(8);
+    std::vector<rts::async::Future<std::string>> futures;
+    for (auto& p : promises)
+        futures.push_back(p.get_future());
+
+    auto any = rts::async::when_any(futures);
+    // Promises with continuations are fulfilled from a worker.
+    rts::async::spawn([&promises] {
+        promises[5].set_value(std::string("five"));
+        promises[2].set_value(std::string("two"));
+    }).get();
+    const auto [index, value] = any.get();
+    EXPECT_EQ(index, 5u);
+    EXPECT_EQ(value, "five");
+
+    // cancel_losers cancels every other input of the range.
+    std::vector<rts::async::CancellationSource> sources(4);
+    std::vector<rts::async::Promise<void>> cancellable;
+    std::vector<rts::async::Future<void>> voids;
+    for (auto& source : sources) {
+        cancellable.emplace_back(source.token());
+        voids.push_back(cancellable.back().get_future());
+    }
+    auto first = rts::async::when_any(rts::async::cancel_losers, voids);
+    rts::async::spawn([&cancellable] { cancellable[3].set_value(); }).get();
+    EXPECT_EQ(first.get(), 3u);
+    EXPECT_TRUE(sources[0].is_cancellation_requested());
+    EXPECT_FALSE(sources[3].is_cancellation_requested());
+
+    rts::finalize_soft();
+}
+
+TEST(ThreadPoolTests, TestWhenAnyEmptyRange) {
+    pin_to_core(5);
+    rts::initialize_runtime(2, 1024);
+
+    // No input can win: the result is ready with an exception rather than never ready.
+    std::vector<rts::async::Future<int>> none;
+    auto any = rts::async::when_any(none);
+    ASSERT_TRUE(any.is_ready());
+    EXPECT_THROW(any.get(), std::invalid_argument);
+
+    std::vector<rts::async::Future<void>> no_voids;
+    EXPECT_THROW(rts::async::when_any(rts::async::cancel_losers, no_voids).get(), std::invalid_argument);
+
+    rts::finalize_soft();
+}
@@ -0,0 +1,135 @@
+// rts-top: live view of the scheduler counters a MiniRTS process publishes with
+// rts::set_metrics_segment().
+//
+// Usage: rts-top <pid | /segment-name> [refresh_ms] [refreshes]
+//
+// Shows, per worker, the rate of tasks executed, local pops and pushes, inbox transfers,
+// steals and parks over the last refresh, the current depth of its WSQ and inbox, plus the
+// pool's saturation. Runs until the segment goes away, or for `refreshes` screens when given.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "metrics.h"
+
+using rts::core::MetricsSegment;
+using rts::core::MetricsSnapshot;
+using rts::core::WorkerStats;
+
+namespace {
+
+    // Prints one row of rates (per second) between two readings of the same counters.
+    void print_row(const char* label, const WorkerStats& now, const WorkerStats& before, double seconds) {
+        const auto rate = [seconds](uint64_t a, uint64_t b) { return static_cast<double>(a - b) / seconds; };
+        const uint64_t attempts = now.steal_attempts - before.steal_attempts;
+        const uint64_t successes = now.steal_successes - before.steal_successes;
+        std::printf("%-8s %12.0f %12.0f %12.0f %12.0f %12.0f %8.1f%% %10.0f %8.0f %8llu %8llu\n",
+                    label,
+                    rate(now.tasks_executed, before.tasks_executed),
+                    rate(now.local_pops, before.local_pops),
+                    rate(now.local_pushes, before.local_pushes),
+                    rate(now.inbox_transfers, before.inbox_transfers),
+                    rate(now.steal_attempts, before.steal_attempts),
+                    attempts ? 100.0 * static_cast<double>(successes) / static_cast<double>(attempts) : 0.0,
+                    rate(now.tasks_stolen, before.tasks_stolen),
+                    rate(now.parks, before.parks),
+                    static_cast<unsigned long long>(now.wsq_depth),
+                    static_cast<unsigned long long>(now.inbox_depth));
+    }
+
+    // Whether `now` cannot follow `before`: a counter went backwards.
+    bool went_backwards(const WorkerStats& now, const WorkerStats& before) {
+        return now.tasks_executed < before.tasks_executed
+            || now.local_pops < before.local_pops
+            || now.local_pushes < before.local_pushes
+            || now.inbox_transfers < before.inbox_transfers
+            || now.steal_attempts < before.steal_attempts
+            || now.steal_successes < before.steal_successes
+            || now.tasks_stolen < before.tasks_stolen
+            || now.idle_iterations < before.idle_iterations
+            || now.parks < before.parks;
+    }
+
+    // Whether `now` was published by another runtime than `before`, so rates between them mean nothing.
+    bool restarted(const MetricsSnapshot& now, const MetricsSnapshot& before) {
+        if (now.pid != before.pid || now.stats.workers.size() != before.stats.workers.size())
+            return true;
+        for (size_t i = 0; i < now.stats.workers.size(); ++i) {
+            if (went_backwards(now.stats.workers[i], before.stats.workers[i]))
+                return true;
+        }
+        return false;
+    }
+
+    void print_screen(const std::string& name, const MetricsSnapshot& now, const MetricsSnapshot& before) {
+        const double seconds = static_cast<double>(now.published_at_ns - before.published_at_ns) / 1e9;
+
+        std::printf("\033[H\033[2J");   // Home, clear screen.
+        std::printf("rts-top  %s  pid %lld  %zu workers  saturation %.4f\n\n",
+                    name.c_str(), static_cast<long long>(now.pid), now.stats.workers.size(), now.stats.saturation);
+        std::printf("%-8s %12s %12s %12s %12s %12s %9s %10s %8s %8s %8s\n",
+                    "worker", "tasks/s", "pops/s", "pushes/s", "inbox/s", "steals/s", "steal ok", "stolen/s", "parks/s",
+                    "wsq", "inbox");
+        if (seconds <= 0) {
+            std::printf("(waiting for the next publication)\n");
+        } else {
+            for (size_t i = 0; i < now.stats.workers.size(); ++i) {
+                const std::string label = std::to_string(i);
+                print_row(label.c_str(), now.stats.workers[i], before.stats.workers[i], seconds);
+            }
+            print_row("total", now.stats.total, before.stats.total, seconds);
+        }
+        std::fflush(stdout);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <pid | /segment-name> [refresh_ms] [refreshes]\n", argv[0]);
+        return 2;
+    }
+
+    const std::string target = argv[1];
+    const std::string name = target.front() == '/' ? target : rts::core::metrics_segment_for(std::atoll(target.c_str()));
+    const auto refresh = std::chrono::milliseconds(argc > 2 ? std::atoll(argv[2]) : 1000);
+    const long long refreshes = argc > 3 ? std::atoll(argv[3]) : -1;
+
+    MetricsSegment segment;
+    if (!segment.open(name)) {
+        std::fprintf(stderr, "rts-top: no MiniRTS metrics segment %s\n", name.c_str());
+        return 1;
+    }
+
+    std::optional<MetricsSnapshot> before = segment.read();
+    for (long long i = 0; refreshes < 0 || i < refreshes; ++i) {
+        std::this_thread::sleep_for(refresh);
+
+        // The publisher removes the segment when its runtime is finalized.
+        MetricsSegment probe;
+        if (!probe.open(name)) {
+            std::printf("\nrts-top: %s is gone\n", name.c_str());
+            return 0;
+        }
+        segment = std::move(probe);
+
+        std::optional<MetricsSnapshot> now = segment.read();
+        if (!now) {
+            // Left mid-update: keep polling in case a new runtime takes over the name.
+            std::printf("\nrts-top: %s is stale (its publisher stopped while updating it)\n", name.c_str());
+            std::fflush(stdout);
+            before.reset();
+            continue;
+        }
+        if (!before || restarted(*now, *before))
+            before = now;   // A new runtime took over the name.
+        print_screen(name, *now, *before);
+        before = std::move(now);
+    }
+    return 0;
+}